@@ -68,6 +68,7 @@ public:
     void run() {
         while (m_engine_runtime->is_active()) {
             tick(m_engine_runtime->get_delta_time());
+            m_engine_runtime->frame_pacer().end_frame();
         }
     }
 
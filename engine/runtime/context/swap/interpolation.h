@@ -0,0 +1,119 @@
+#pragma once
+
+#include "engine/runtime/context/swap/swap_data.h"
+#include "engine/runtime/tool/math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+namespace rtr {
+
+namespace detail {
+
+// whether T * R * S, the order decompose() assumes, equals the engine's T * S * R
+inline bool is_rigid_with_uniform_scale(const glm::vec3& scale, const glm::vec3& skew) {
+    constexpr float epsilon = 1e-4f;
+    auto tolerance = epsilon * std::max({std::abs(scale.x), std::abs(scale.y), std::abs(scale.z), 1.0f});
+    return std::abs(scale.x - scale.y) <= tolerance && std::abs(scale.x - scale.z) <= tolerance &&
+        glm::all(glm::lessThanEqual(glm::abs(skew), glm::vec3(epsilon)));
+}
+
+}
+
+// Blends translation, rotation and scale. Matrices with shear or non-uniform scale,
+// e.g. under a non-uniformly scaled parent, do not decompose into the engine's
+// T * S * R order and are blended element-wise instead.
+inline glm::mat4 interpolate_transform(const glm::mat4& from, const glm::mat4& to, float alpha) {
+    if (from == to) {
+        return to;
+    }
+
+    glm::vec3 from_scale{}, to_scale{};
+    glm::quat from_rotation{}, to_rotation{};
+    glm::vec3 from_translation{}, to_translation{};
+    glm::vec3 from_skew{}, to_skew{};
+    glm::vec4 perspective{};
+
+    if (!glm::decompose(from, from_scale, from_rotation, from_translation, from_skew, perspective) ||
+        !glm::decompose(to, to_scale, to_rotation, to_translation, to_skew, perspective)) {
+        return to;
+    }
+
+    if (!detail::is_rigid_with_uniform_scale(from_scale, from_skew) || !detail::is_rigid_with_uniform_scale(to_scale, to_skew)) {
+        return from + (to - from) * alpha;
+    }
+
+    auto translation = glm::mix(from_translation, to_translation, alpha);
+    auto rotation = glm::slerp(from_rotation, to_rotation, alpha);
+    auto scale = glm::mix(from_scale, to_scale, alpha);
+
+    return glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+}
+
+inline Swap_camera interpolate_camera(const Swap_camera& from, const Swap_camera& to, float alpha) {
+    auto camera = to;
+    // blend the camera's world transform, the view matrix is its inverse
+    camera.view_matrix = glm::inverse(interpolate_transform(
+        glm::inverse(from.view_matrix),
+        glm::inverse(to.view_matrix),
+        alpha
+    ));
+    camera.camera_position = glm::mix(from.camera_position, to.camera_position, alpha);
+    camera.camera_direction = glm::normalize(glm::mix(from.camera_direction, to.camera_direction, alpha));
+    return camera;
+}
+
+// Builds the render swap data between two fixed-step logic states. Everything is
+// taken from the newer state; model matrices and the camera are blended with the
+// matching record of the older state. Objects that only exist in the newer state
+// are rendered as they are.
+class Swap_interpolator {
+private:
+    std::unordered_map<uint32_t, uint32_t> m_previous_index_of{};
+
+public:
+    void interpolate(const Swap_data& previous, const Swap_data& current, float alpha, Swap_data& out) {
+        out.clear();
+        out.append(current);
+
+        if (previous.has_camera && current.has_camera) {
+            out.camera = interpolate_camera(previous.camera, current.camera, alpha);
+        }
+
+        bool is_index_map_built = false;
+        for (uint32_t i = 0; i < out.render_objects.size(); i++) {
+            auto& object = out.render_objects[i];
+
+            // objects are usually emitted in the same order every step
+            const Swap_renderable_object* previous_object{nullptr};
+            if (i < previous.render_objects.size() && previous.render_objects[i].object_id == object.object_id) {
+                previous_object = &previous.render_objects[i];
+            } else {
+                if (!is_index_map_built) {
+                    build_index_map(previous);
+                    is_index_map_built = true;
+                }
+                if (auto it = m_previous_index_of.find(object.object_id); it != m_previous_index_of.end()) {
+                    previous_object = &previous.render_objects[it->second];
+                }
+            }
+
+            if (previous_object) {
+                object.model_matrix = interpolate_transform(previous_object->model_matrix, object.model_matrix, alpha);
+            }
+        }
+    }
+
+private:
+    void build_index_map(const Swap_data& previous) {
+        m_previous_index_of.clear();
+        for (uint32_t i = 0; i < previous.render_objects.size(); i++) {
+            m_previous_index_of[previous.render_objects[i].object_id] = i;
+        }
+    }
+
+};
+
+}
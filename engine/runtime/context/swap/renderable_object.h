@@ -5,22 +5,52 @@
 
 #include "engine/runtime/function/render/material/material.h"
 #include "engine/runtime/function/render/utils/skybox.h"
+#include "engine/runtime/resource/handle_table.h"
+#include "engine/runtime/tool/singleton.h"
 
 #include "glm/fwd.hpp"
+#include <cstdint>
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace rtr {
 
+using Material_handle = Resource_handle<Material>;
+using Geometry_handle = Resource_handle<Geometry>;
+
+using Material_table = Singleton<Resource_handle_table<Material>>;
+using Geometry_table = Singleton<Resource_handle_table<Geometry>>;
+
 struct Swap_renderable_object {
-    std::shared_ptr<Material> material{};
-    std::shared_ptr<Geometry> geometry{};
+    // stable across frames, used to pair records of consecutive logic states
+    uint32_t object_id{};
+    Material_handle material{};
+    Geometry_handle geometry{};
+    // slot in the scene's Transform_storage, model_matrix is filled from it after the logic tick
+    uint32_t transform_index{};
     glm::mat4 model_matrix{1.0f};
     bool is_cast_shadow{false};
 };
 
-struct Swap_shadow_caster_renderable_object {
-    std::shared_ptr<Geometry> geometry{};
-    glm::mat4 model_matrix{1.0f};
+static_assert(std::is_trivially_copyable_v<Swap_renderable_object>);
+
+enum class Swap_render_change_type : uint8_t {
+    ADDED,
+    // material, geometry or shadow flag changed, the whole record is replaced
+    CHANGED,
+    // only object_id and model_matrix of the record are meaningful
+    TRANSFORMED,
+    // only object_id of the record is meaningful
+    REMOVED
 };
+
+// One entry of the change journal written in incremental mode, see Swap_data::is_incremental.
+struct Swap_render_change {
+    Swap_render_change_type type{Swap_render_change_type::ADDED};
+    Swap_renderable_object object{};
+};
+
+static_assert(std::is_trivially_copyable_v<Swap_render_change>);
+
 }
\ No newline at end of file
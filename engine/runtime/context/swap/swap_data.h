@@ -9,22 +9,50 @@
 
 #include "engine/runtime/function/render/material/material.h"
 #include "engine/runtime/function/render/utils/skybox.h"
+#include "engine/runtime/tool/linear_arena.h"
 
 #include "glm/fwd.hpp"
+#include <cstdint>
 #include <memory>
 #include <vector>
 
 namespace rtr {
 
-
-struct Swap_data {
-    
-    Swap_camera camera{};
+// Records of the static game objects in a scene, built once and then shared read
+// only by every swap buffer until a static object changes.
+struct Static_render_list {
     std::vector<Swap_renderable_object> render_objects{};
+    // indices into render_objects of the shadow casting objects
+    std::vector<uint32_t> shadow_caster_indices{};
 
     std::vector<Swap_directional_light> directional_lights{};
     std::vector<Swap_point_light> point_lights{};
     std::vector<Swap_spot_light> spot_lights{};
+};
+
+struct Swap_data {
+
+    // backs the per-frame record vectors below; clear() rewinds it, so once the
+    // arena has grown to a frame's working set, filling the buffer never allocates
+    std::unique_ptr<Linear_arena> frame_arena{Linear_arena::create()};
+    
+    Swap_camera camera{};
+    bool has_camera{false};
+
+    // Incremental buffers leave render_objects empty: mesh renderers only journal what
+    // was added, changed or removed since the previous logic frame, and the render side
+    // applies the journal to the Render_scene it keeps. Every journal has to be applied
+    // exactly once, in order. Survives clear().
+    bool is_incremental{false};
+    Arena_vector<Swap_render_change> render_changes{frame_arena.get()};
+
+    Arena_vector<Swap_renderable_object> render_objects{frame_arena.get()};
+    // drawn in addition to render_objects
+    std::shared_ptr<const Static_render_list> static_render_list{};
+
+    Arena_vector<Swap_directional_light> directional_lights{frame_arena.get()};
+    Arena_vector<Swap_point_light> point_lights{frame_arena.get()};
+    Arena_vector<Swap_spot_light> spot_lights{frame_arena.get()};
 
     std::shared_ptr<Skybox> skybox{};    
 
@@ -33,28 +61,81 @@ struct Swap_data {
     bool enable_csm_shadow{false};
     std::vector<Swap_CSM_shadow_caster> csm_shadow_casters{};
 
+    // indices into render_objects of the shadow casting objects, filled on the render side
+    Arena_vector<uint32_t> shadow_caster_indices{frame_arena.get()};
+
     void clear() {
-        render_objects.clear();
-        point_lights.clear();
-        spot_lights.clear();
-        directional_lights.clear();
+        auto render_change_count = render_changes.size();
+        auto render_object_count = render_objects.size();
+        auto directional_light_count = directional_lights.size();
+        auto point_light_count = point_lights.size();
+        auto spot_light_count = spot_lights.size();
+        auto shadow_caster_count = shadow_caster_indices.size();
+
+        // the vectors must let go of their arena storage before the arena is rewound
+        render_changes = Arena_vector<Swap_render_change>{frame_arena.get()};
+        render_objects = Arena_vector<Swap_renderable_object>{frame_arena.get()};
+        directional_lights = Arena_vector<Swap_directional_light>{frame_arena.get()};
+        point_lights = Arena_vector<Swap_point_light>{frame_arena.get()};
+        spot_lights = Arena_vector<Swap_spot_light>{frame_arena.get()};
+        shadow_caster_indices = Arena_vector<uint32_t>{frame_arena.get()};
+        frame_arena->reset();
+
+        render_changes.reserve(render_change_count);
+        render_objects.reserve(render_object_count);
+        directional_lights.reserve(directional_light_count);
+        point_lights.reserve(point_light_count);
+        spot_lights.reserve(spot_light_count);
+        shadow_caster_indices.reserve(shadow_caster_count);
+
         csm_shadow_casters.clear();
         camera = Swap_camera{};
+        has_camera = false;
         dl_shadow_casters = Swap_directional_light_shadow_caster{};
         skybox.reset();
+        static_render_list.reset();
+    }
+
+    // Appends a shard filled by a parallel tick; single-instance entries such as the
+    // camera are taken from the shard only when the shard actually wrote them.
+    void append(const Swap_data& shard) {
+        render_changes.insert(render_changes.end(), shard.render_changes.begin(), shard.render_changes.end());
+        render_objects.insert(render_objects.end(), shard.render_objects.begin(), shard.render_objects.end());
+        directional_lights.insert(directional_lights.end(), shard.directional_lights.begin(), shard.directional_lights.end());
+        point_lights.insert(point_lights.end(), shard.point_lights.begin(), shard.point_lights.end());
+        spot_lights.insert(spot_lights.end(), shard.spot_lights.begin(), shard.spot_lights.end());
+
+        if (shard.has_camera) {
+            camera = shard.camera;
+            has_camera = true;
+        }
+
+        if (shard.skybox) {
+            skybox = shard.skybox;
+        }
+
+        if (shard.static_render_list) {
+            static_render_list = shard.static_render_list;
+        }
+
+        if (shard.dl_shadow_casters.shadow_map) {
+            dl_shadow_casters = shard.dl_shadow_casters;
+        }
+
+        if (shard.enable_csm_shadow) {
+            enable_csm_shadow = true;
+            csm_shadow_casters = shard.csm_shadow_casters;
+        }
     }
 
-    std::vector<Swap_shadow_caster_renderable_object> get_shadow_casters() const {
-        std::vector<Swap_shadow_caster_renderable_object> shadow_casters{};
-        for (const auto& obj : render_objects) {
-            if (obj.is_cast_shadow) {
-                shadow_casters.push_back({
-                    .geometry = obj.geometry,
-                    .model_matrix = obj.model_matrix
-                });
+    const Arena_vector<uint32_t>& update_shadow_caster_indices() {
+        shadow_caster_indices.clear();
+        for (uint32_t i = 0; i < render_objects.size(); i++) {
+            if (render_objects[i].is_cast_shadow) {
+                shadow_caster_indices.push_back(i);
             }
         }
-        return shadow_casters;
+        return shadow_caster_indices;
     }
 };
 
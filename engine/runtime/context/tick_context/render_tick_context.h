@@ -2,18 +2,30 @@
 
 #include "engine/runtime/context/swap/swap_data.h"
 #include "engine/runtime/function/input/input_system.h"
+#include <memory>
+#include <utility>
 
 namespace rtr {
+
+class Frame_buffer;
+class Render_scene;
     
 struct Render_tick_context {
     Swap_data &render_swap_data;
     float delta_time{};
+    // set by the render system when render_swap_data is incremental, holds the
+    // renderable objects with the swap data's journal applied
+    Render_scene* render_scene{nullptr};
+    // offscreen frame buffer the frame ends up in, the window's screen buffer when null
+    std::shared_ptr<Frame_buffer> target{};
     
     Render_tick_context(
         Swap_data &render_swap_data,
-        float delta_time
+        float delta_time,
+        std::shared_ptr<Frame_buffer> target = nullptr
     ) : render_swap_data(render_swap_data),
-        delta_time(delta_time) {}
+        delta_time(delta_time),
+        target(std::move(target)) {}
 };
 
 }
\ No newline at end of file
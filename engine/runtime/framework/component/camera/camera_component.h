@@ -32,6 +32,7 @@ public:
             .near = m_camera->near_bound(),
             .far = m_camera->far_bound()
         };
+        data.has_camera = true;
         
     }
 
@@ -2,7 +2,18 @@
 
 
 #include "engine/runtime/context/tick_context/logic_tick_context.h"
+#include "engine/runtime/tool/pool_allocator.h"
+#include "engine/runtime/tool/type_id.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace rtr {
@@ -19,65 +30,235 @@ enum class Component_type {
 
 class Base_component;
 
+// Reference to a game object in a Scene. The generation changes whenever the slot
+// is reused, so handles to despawned objects stay detectably stale.
+struct Game_object_handle {
+    static constexpr uint32_t invalid_index = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index{invalid_index};
+    uint32_t generation{0};
+
+    bool is_valid() const { return index != invalid_index; }
+    bool operator==(const Game_object_handle&) const = default;
+};
+
+// Small dense index per component type_id, handed out on first use. Addresses the
+// per type storages of Component_registry.
+class Component_type_index {
+public:
+    template<typename T>
+    static uint32_t of() {
+        static const uint32_t index = of(type_id<T>());
+        return index;
+    }
+
+    static uint32_t of(uint64_t type_id) {
+        std::lock_guard<std::mutex> lock(mutex());
+        auto& map = indices();
+        return map.try_emplace(type_id, static_cast<uint32_t>(map.size())).first->second;
+    }
+
+private:
+    static std::mutex& mutex() {
+        static std::mutex mutex{};
+        return mutex;
+    }
+
+    static std::unordered_map<uint64_t, uint32_t>& indices() {
+        static std::unordered_map<uint64_t, uint32_t> indices{};
+        return indices;
+    }
+};
+
+// Scene wide sparse-set storage: one dense array per exact component type, so all
+// components of a kind can be iterated without visiting their game objects. Every
+// component remembers its dense slot, removal swaps the last element into it.
+// Not thread safe, components must not be attached or detached while ticking.
+class Component_registry {
+public:
+    static constexpr uint32_t invalid_index = std::numeric_limits<uint32_t>::max();
+
+private:
+    std::vector<std::vector<Base_component*>> m_storages{};
+    // per type index, see set_tick_batched
+    std::vector<uint8_t> m_is_tick_batched{};
+    // bumped whenever a component is added or removed
+    uint64_t m_version{};
+    // per type index, see set_remove_callback
+    std::vector<std::function<void(Base_component&)>> m_remove_callbacks{};
+
+public:
+    Component_registry() = default;
+    Component_registry(const Component_registry&) = delete;
+    Component_registry& operator=(const Component_registry&) = delete;
+
+    inline void add(Base_component* component);
+    inline void remove(Base_component* component);
+
+    // components whose dynamic type is exactly T
+    template<typename T>
+    const std::vector<Base_component*>& storage() const {
+        static const std::vector<Base_component*> empty{};
+        auto index = Component_type_index::of<T>();
+        return index < m_storages.size() ? m_storages[index] : empty;
+    }
+
+    template<typename T>
+    std::size_t count() const { return storage<T>().size(); }
+
+    uint64_t version() const { return m_version; }
+
+    // Components of a batched type are ticked all at once by a system, so
+    // Game_object::tick skips them; applies to the ones added later as well.
+    inline void set_tick_batched(uint32_t type_index, bool is_batched);
+
+    bool is_tick_batched(uint32_t type_index) const {
+        return type_index < m_is_tick_batched.size() && m_is_tick_batched[type_index];
+    }
+
+    // called with every component of the type leaving the registry, whether it was
+    // removed from its game object or its game object left the scene
+    void set_remove_callback(uint32_t type_index, std::function<void(Base_component&)> callback) {
+        if (type_index >= m_remove_callbacks.size()) {
+            m_remove_callbacks.resize(type_index + 1);
+        }
+        m_remove_callbacks[type_index] = std::move(callback);
+    }
+
+    template<typename T, typename Func>
+    void for_each(Func&& func) const {
+        for (auto* component : storage<T>()) {
+            func(*static_cast<T*>(component));
+        }
+    }
+};
+
 class Component_list : public std::enable_shared_from_this<Component_list> {
 
 protected:
     std::vector<std::shared_ptr<Base_component>> m_components{};
 
+    // (type id, first component of exactly that type) per type in the list, rebuilt
+    // whenever the components or their order change, so lookups only ever read it
+    std::vector<std::pair<uint64_t, std::shared_ptr<Base_component>>> m_lookup{};
+
+    // m_components is kept sorted by priority, re-sorted lazily after adds and priority changes
+    bool m_is_order_dirty{false};
+
+    Component_registry* m_registry{nullptr};
+    // slot of the owning game object in its scene, maintained by the scene
+    Game_object_handle m_scene_handle{};
+
 public:
+    Component_list() = default;
+    inline ~Component_list();
 
-    void add_component(const std::shared_ptr<Base_component>& component) {
+    Component_list(const Component_list&) = delete;
+    Component_list& operator=(const Component_list&) = delete;
+
+    const Game_object_handle& scene_handle() const { return m_scene_handle; }
+    void set_scene_handle(const Game_object_handle& handle) { m_scene_handle = handle; }
+
+    // T is the component's dynamic type, unless the component already knows its
+    // type_id, like the clones of a Prefab
+    template <typename T>
+    void add_component(const std::shared_ptr<T>& component) {
+        if (component->component_type_id() == 0) {
+            if (typeid(*component) != typeid(T)) {
+                throw std::invalid_argument("Component_list: " + readable_type_name(typeid(*component)) + " added as " + readable_type_name(typeid(T)));
+            }
+            component->set_component_type_id(type_id<T>());
+        }
         m_components.push_back(component);
+        if (m_registry) {
+            m_registry->add(component.get());
+        }
+        m_is_order_dirty = true;
+        rebuild_lookup();
     }
 
     template <typename T>
     const std::shared_ptr<T> get_component() const {
-        for (auto& component : m_components) {
-            if (auto ptr = std::dynamic_pointer_cast<T>(component)) {
-                return ptr;
-            }
-        }
-        return nullptr;
+        return std::static_pointer_cast<T>(find<T>());
     }
 
     template <typename T>
     std::shared_ptr<T> get_component() {
-        for (auto& component : m_components) {
-            if (auto ptr = std::dynamic_pointer_cast<T>(component)) {
-                return ptr;
-            }
-        }
-        return nullptr;
+        return std::static_pointer_cast<T>(find<T>());
     }
 
     template <typename T>
     void remove_component() {
-        for (auto it = m_components.begin(); it != m_components.end(); ++it) {
-            if (auto ptr = std::dynamic_pointer_cast<T>(*it)) {
-                m_components.erase(it);
-                return;
-            }
+        auto component = find<T>();
+        if (!component) {
+            return;
+        }
+        m_components.erase(std::find(m_components.begin(), m_components.end(), component));
+        if (m_registry) {
+            m_registry->remove(component.get());
         }
+        rebuild_lookup();
     }
 
     template <typename T>
     bool has_component() const {
+        return find<T>() != nullptr;
+    }
+
+    const std::vector<std::shared_ptr<Base_component>>& components() const { return m_components; }
+
+    // components by ascending priority, equal priorities in insertion order
+    inline const std::vector<std::shared_ptr<Base_component>>& sorted_components();
+
+    void mark_order_dirty() { m_is_order_dirty = true; }
+
+    Component_registry* registry() const { return m_registry; }
+
+    // moves all components of this list from the current registry, if any, to registry
+    void set_registry(Component_registry* registry) {
+        if (m_registry == registry) {
+            return;
+        }
         for (auto& component : m_components) {
-            if (auto ptr = std::dynamic_pointer_cast<T>(component)) {
-                return true;
+            if (m_registry) {
+                m_registry->remove(component.get());
+            }
+            if (registry) {
+                registry->add(component.get());
             }
         }
-        return false;
+        m_registry = registry;
     }
 
-    const std::vector<std::shared_ptr<Base_component>>& components() const { return m_components; }
-
     void sort_components(
         std::function<bool(const std::shared_ptr<Base_component>& a, const std::shared_ptr<Base_component>& b)> compare
     ) {
         std::sort(m_components.begin(), m_components.end(), compare);
+        rebuild_lookup();
+    }
+
+private:
+    // a component of exactly type T if there is one, else the first that derives from T;
+    // never writes, so game objects can be looked into from several threads
+    template <typename T>
+    const std::shared_ptr<Base_component>& find() const {
+        static const std::shared_ptr<Base_component> none{};
+        constexpr auto id = type_id<T>();
+        for (auto& [lookup_id, component] : m_lookup) {
+            if (lookup_id == id) {
+                return component;
+            }
+        }
+        for (auto& component : m_components) {
+            if (dynamic_cast<T*>(component.get())) {
+                return component;
+            }
+        }
+        return none;
     }
 
+    inline void rebuild_lookup();
+
 };
 
 class Base_component {
@@ -85,21 +266,48 @@ class Base_component {
 protected:
     Component_type m_component_type{};
     bool m_is_enabled{true};
+    // set by the registry while a system ticks this component's type
+    bool m_is_tick_batched{false};
     int m_priority{0};
     std::weak_ptr<Component_list> m_component_list{};
 
+    // dense slot in the scene's Component_registry, maintained by the registry
+    uint32_t m_registry_type_index{Component_registry::invalid_index};
+    uint32_t m_registry_index{Component_registry::invalid_index};
+
+    // type_id of the dynamic type, set on the first add_component; keys the registry
+    // storages and the Component_list lookups
+    uint64_t m_component_type_id{0};
+
+    friend class Component_registry;
+
 public:
     Base_component() : m_component_type(Component_type::CUSTOM) {}
     Base_component(Component_type type) : m_component_type(type) {}
     virtual ~Base_component() = default;
     virtual void tick(const Logic_tick_context& tick_context) = 0;
     virtual void on_add_to_game_object() {}
+    // A detached copy of the component's settings for Prefab instantiation, wired up
+    // again by on_add_to_game_object(); nullptr for components that can't be cloned.
+    virtual std::shared_ptr<Base_component> clone() const { return nullptr; }
+    // false when tick() reads or writes state owned by other game objects,
+    // which forces the owning game object onto the serial path of a parallel scene tick
+    virtual bool is_parallel_tick_safe() const { return true; }
     Component_type component_type() const { return m_component_type; }
     bool is_enabled() const { return m_is_enabled; }
     void set_enabled(bool enabled) { m_is_enabled = enabled; }
+    bool is_tick_batched() const { return m_is_tick_batched; }
+    uint64_t component_type_id() const { return m_component_type_id; }
+    void set_component_type_id(uint64_t type_id) { m_component_type_id = type_id; }
     int priority() const { return m_priority; }
     void set_priority(int priority) { 
+        if (m_priority == priority) {
+            return;
+        }
         m_priority = priority; 
+        if (auto list = component_list()) {
+            list->mark_order_dirty();
+        }
     }
 
     bool is_attached_to_gameobject() const { return component_list() != nullptr; }
@@ -124,7 +332,7 @@ public:
 
     template<typename T>
     std::shared_ptr<T> add_component() {
-        auto component = std::make_shared<T>();
+        auto component = make_pooled<T>();
         component_list()->add_component(component);
         component->set_component_list(component_list());
         component->on_add_to_game_object();
@@ -148,4 +356,80 @@ public:
 };
 
 
+inline void Component_registry::add(Base_component* component) {
+    if (component->m_registry_index != invalid_index) {
+        return;
+    }
+    auto type_index = Component_type_index::of(component->m_component_type_id);
+    if (type_index >= m_storages.size()) {
+        m_storages.resize(type_index + 1);
+    }
+    auto& storage = m_storages[type_index];
+    component->m_registry_type_index = type_index;
+    component->m_registry_index = static_cast<uint32_t>(storage.size());
+    component->m_is_tick_batched = is_tick_batched(type_index);
+    storage.push_back(component);
+    m_version++;
+}
+
+inline void Component_registry::remove(Base_component* component) {
+    if (component->m_registry_index == invalid_index) {
+        return;
+    }
+    auto type_index = component->m_registry_type_index;
+    if (type_index < m_remove_callbacks.size() && m_remove_callbacks[type_index]) {
+        m_remove_callbacks[type_index](*component);
+    }
+    auto& storage = m_storages[type_index];
+    auto* last = storage.back();
+    storage[component->m_registry_index] = last;
+    last->m_registry_index = component->m_registry_index;
+    storage.pop_back();
+    component->m_registry_type_index = invalid_index;
+    component->m_registry_index = invalid_index;
+    component->m_is_tick_batched = false;
+    m_version++;
+}
+
+inline void Component_registry::set_tick_batched(uint32_t type_index, bool is_batched) {
+    if (type_index >= m_is_tick_batched.size()) {
+        m_is_tick_batched.resize(type_index + 1, 0);
+    }
+    m_is_tick_batched[type_index] = is_batched;
+    if (type_index < m_storages.size()) {
+        for (auto* component : m_storages[type_index]) {
+            component->m_is_tick_batched = is_batched;
+        }
+    }
+}
+
+inline const std::vector<std::shared_ptr<Base_component>>& Component_list::sorted_components() {
+    if (m_is_order_dirty) {
+        // insertion sort: stable, allocation free and linear on the almost sorted lists it sees
+        for (std::size_t i = 1; i < m_components.size(); i++) {
+            for (auto j = i; j > 0 && m_components[j]->priority() < m_components[j - 1]->priority(); j--) {
+                std::swap(m_components[j], m_components[j - 1]);
+            }
+        }
+        m_is_order_dirty = false;
+        rebuild_lookup();
+    }
+    return m_components;
+}
+
+inline void Component_list::rebuild_lookup() {
+    m_lookup.clear();
+    for (auto& component : m_components) {
+        auto id = component->component_type_id();
+        auto is_listed = std::any_of(m_lookup.begin(), m_lookup.end(), [&](const auto& entry) { return entry.first == id; });
+        if (!is_listed) {
+            m_lookup.emplace_back(id, component);
+        }
+    }
+}
+
+inline Component_list::~Component_list() {
+    set_registry(nullptr);
+}
+
 };
\ No newline at end of file
@@ -11,6 +11,7 @@ protected:
     glm::vec3 m_position{};
     float m_speed{1.0f};
     float m_amplitude{1.0f};
+    double m_time{0.0};
     std::shared_ptr<Node> m_node{};
 public:
     Ping_pong_component() : Base_component(Component_type::CUSTOM) {}
@@ -18,6 +19,15 @@ public:
     void on_add_to_game_object() override {
         m_node = get_component<Node_component>()->node();
     }
+
+    std::shared_ptr<Base_component> clone() const override {
+        auto component = make_pooled<Ping_pong_component>();
+        component->m_position = m_position;
+        component->m_speed = m_speed;
+        component->m_amplitude = m_amplitude;
+        component->m_time = m_time;
+        return component;
+    }
  
     float& speed() { return m_speed; }
     const float& speed() const { return m_speed; }
@@ -39,11 +49,13 @@ public:
     float& amplitude() {
         return m_amplitude;
     }
+
+    double time() const { return m_time; }
+    double& time() { return m_time; }
     
     void tick(const Logic_tick_context& tick_context) override {
-        static double t = 0; 
-        t += m_speed * tick_context.delta_time;
-        auto position = m_position + glm::vec3(0.0f,  m_amplitude * sin(t), 0.0f);
+        m_time += m_speed * tick_context.delta_time;
+        auto position = m_position + glm::vec3(0.0f,  m_amplitude * sin(m_time), 0.0f);
         m_node->set_position(position);
     }
 
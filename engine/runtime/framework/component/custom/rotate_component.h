@@ -19,6 +19,13 @@ public:
         m_node = get_component<Node_component>()->node();
     }
 
+    std::shared_ptr<Base_component> clone() const override {
+        auto component = make_pooled<Rotate_component>();
+        component->m_axis = m_axis;
+        component->m_speed = m_speed;
+        return component;
+    }
+
     glm::vec3& axis() { return m_axis; }
     float& speed() { return m_speed; }
     const glm::vec3& axis() const { return m_axis; }
@@ -32,7 +39,7 @@ public:
     }
 
     static std::shared_ptr<Rotate_component> create() {
-        return std::make_shared<Rotate_component>();
+        return make_pooled<Rotate_component>();
     }
 };
 
@@ -24,7 +24,7 @@ public:
     static std::shared_ptr<Mesh_renderer> create(
         const std::shared_ptr<Node>& node
     ) {
-        return std::make_shared<Mesh_renderer>(node);
+        return make_pooled<Mesh_renderer>(node);
     }
 
     const std::shared_ptr<Node>& node() const {return m_node; }
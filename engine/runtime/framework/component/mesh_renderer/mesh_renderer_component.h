@@ -5,15 +5,37 @@
 #include "engine/runtime/framework/component/component.h"
 #include "engine/runtime/framework/component/mesh_renderer/mesh_renderer.h"
 #include "engine/runtime/framework/component/node/node_component.h"
+#include <atomic>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <utility>
 
 namespace rtr {
 class Mesh_renderer_component : public Base_component {
 
 protected:
+    inline static std::atomic<uint32_t> s_next_object_id{0};
+
+    uint32_t m_object_id{s_next_object_id.fetch_add(1, std::memory_order_relaxed)};
     std::shared_ptr<Mesh_renderer> m_mesh_renderer{};
     bool m_is_cast_shadow{true};
 
+    // handles are only re-resolved when the renderer switches resources
+    Material_handle m_material_handle{};
+    Geometry_handle m_geometry_handle{};
+
+    // incremental mode: what the render side was last told about this renderer
+    bool m_is_published{false};
+    Material_handle m_published_material_handle{};
+    Geometry_handle m_published_geometry_handle{};
+    bool m_published_cast_shadow{false};
+    // set by every tick, cleared by the scene once it has journaled the frame
+    bool m_has_ticked{false};
+
+    // leaf of the renderer in its scene's spatial index, maintained by the scene
+    uint32_t m_spatial_proxy{std::numeric_limits<uint32_t>::max()};
+
 public:
 
     Mesh_renderer_component() : Base_component(Component_type::MESH_RENDERER) {}
@@ -22,11 +44,29 @@ public:
 
     void on_add_to_game_object() override {
         auto node = component_list()->get_component<Node_component>()->node();
-        m_mesh_renderer = Mesh_renderer::create(node);
+        auto mesh_renderer = Mesh_renderer::create(node);
+        // a clone keeps the geometry and material it was cloned with
+        if (m_mesh_renderer) {
+            mesh_renderer->geometry() = m_mesh_renderer->geometry();
+            mesh_renderer->material() = m_mesh_renderer->material();
+        }
+        m_mesh_renderer = mesh_renderer;
+    }
+
+    // shares geometry and material, so clones add no GPU resources
+    std::shared_ptr<Base_component> clone() const override {
+        auto component = make_pooled<Mesh_renderer_component>();
+        component->m_mesh_renderer = make_pooled<Mesh_renderer>();
+        component->m_mesh_renderer->geometry() = m_mesh_renderer->geometry();
+        component->m_mesh_renderer->material() = m_mesh_renderer->material();
+        component->m_is_cast_shadow = m_is_cast_shadow;
+        component->m_material_handle = m_material_handle;
+        component->m_geometry_handle = m_geometry_handle;
+        return component;
     }
     
     static std::shared_ptr<Mesh_renderer_component> create() {
-        return std::make_shared<Mesh_renderer_component>();
+        return make_pooled<Mesh_renderer_component>();
     }
 
     const std::shared_ptr<Mesh_renderer>& mesh_renderer() const { return m_mesh_renderer; }
@@ -35,14 +75,69 @@ public:
     bool is_cast_shadow() const { return m_is_cast_shadow; }
     bool& is_cast_shadow() { return m_is_cast_shadow; }
 
+    uint32_t object_id() const { return m_object_id; }
+
+    bool is_published() const { return m_is_published; }
+
+    uint32_t spatial_proxy() const { return m_spatial_proxy; }
+    void set_spatial_proxy(uint32_t proxy) { m_spatial_proxy = proxy; }
+
+    // Called by the scene when the renderer leaves the incremental render stream without
+    // ticking again; returns whether the render side has to be told to remove it.
+    bool unpublish() {
+        return std::exchange(m_is_published, false);
+    }
+
+    // whether the renderer ticked since the last call, i.e. emitted a record this frame
+    bool consume_ticked() {
+        return std::exchange(m_has_ticked, false);
+    }
+
     void tick(const Logic_tick_context& tick_context) override {
-        auto& data = tick_context.logic_swap_data;
-        data.render_objects.push_back(Swap_renderable_object{
-            .material = m_mesh_renderer->material(),
-            .geometry = m_mesh_renderer->geometry(),
-            .model_matrix = m_mesh_renderer->node()->model_matrix(),
+        m_has_ticked = true;
+        auto& material = m_mesh_renderer->material();
+        auto& material_table = *Material_table::get_instance();
+        if (material_table.get(m_material_handle) != material.get()) {
+            m_material_handle = material_table.acquire(material);
+        }
+
+        auto& geometry = m_mesh_renderer->geometry();
+        auto& geometry_table = *Geometry_table::get_instance();
+        if (geometry_table.get(m_geometry_handle) != geometry.get()) {
+            m_geometry_handle = geometry_table.acquire(geometry);
+        }
+
+        Swap_renderable_object record{
+            .object_id = m_object_id,
+            .material = m_material_handle,
+            .geometry = m_geometry_handle,
+            .transform_index = m_mesh_renderer->node()->transform_index(),
             .is_cast_shadow = m_is_cast_shadow
-        });
+        };
+
+        auto& data = tick_context.logic_swap_data;
+        if (!data.is_incremental) {
+            data.render_objects.push_back(record);
+            return;
+        }
+
+        // transform changes are journaled by the scene once world matrices are resolved
+        if (!m_is_published) {
+            data.render_changes.push_back(Swap_render_change{Swap_render_change_type::ADDED, record});
+        } else if (
+            m_published_material_handle != m_material_handle ||
+            m_published_geometry_handle != m_geometry_handle ||
+            m_published_cast_shadow != m_is_cast_shadow
+        ) {
+            data.render_changes.push_back(Swap_render_change{Swap_render_change_type::CHANGED, record});
+        } else {
+            return;
+        }
+
+        m_is_published = true;
+        m_published_material_handle = m_material_handle;
+        m_published_geometry_handle = m_geometry_handle;
+        m_published_cast_shadow = m_is_cast_shadow;
     }
     
 };
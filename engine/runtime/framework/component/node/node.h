@@ -1,28 +1,33 @@
 #pragma once
 
+#include "engine/runtime/framework/component/node/transform_storage.h"
 #include "engine/runtime/tool/math.h"
+#include "engine/runtime/tool/pool_allocator.h"
 #include "glm/ext/matrix_float4x4.hpp"
 #include "glm/ext/matrix_transform.hpp"
 #include "glm/fwd.hpp"
 #include "glm/gtc/quaternion.hpp"
+#include <atomic>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 
 namespace rtr {
 
+// Thin handle over a slot in a Transform_storage; the transform data itself
+// lives in the storage's contiguous arrays.
 class Node : public std::enable_shared_from_this<Node> {
 
 protected:
-    glm::mat4 m_model_matrix{glm::identity<glm::mat4>()};
-    bool m_is_dirty{true};
-
-    glm::vec3 m_position{glm::zero<glm::vec3>()};
-    glm::vec3 m_scale{glm::one<glm::vec3>()};
-    glm::quat m_rotation{glm::identity<glm::quat>()};
+    std::shared_ptr<Transform_storage> m_transform_storage{Transform_storage::current()};
+    uint32_t m_transform_index{m_transform_storage->allocate()};
 
     std::vector<std::shared_ptr<Node>> m_children{};
     std::weak_ptr<Node> m_parent{};
 
+    // bumped on every reparent so caches built on the hierarchy can detect changes
+    inline static std::atomic<uint64_t> s_hierarchy_version{0};
+
 public:
     Node() {}
   	~Node() {
@@ -32,12 +37,28 @@ public:
 
         for (auto& child : m_children) {
             child->m_parent.reset();
-            child->set_dirty();
+            m_transform_storage->set_parent(child->m_transform_index, Transform_storage::invalid_index);
+        }
+
+        if (!m_children.empty()) {
+            s_hierarchy_version.fetch_add(1, std::memory_order_relaxed);
         }
+
+        m_transform_storage->release(m_transform_index);
+    }
+
+    Node(const Node&) = delete;
+    Node& operator=(const Node&) = delete;
+
+    const std::shared_ptr<Transform_storage>& transform_storage() const { return m_transform_storage; }
+    uint32_t transform_index() const { return m_transform_index; }
+
+    static uint64_t hierarchy_version() {
+        return s_hierarchy_version.load(std::memory_order_relaxed);
     }
 
 	static std::shared_ptr<Node> create() {
-		return std::make_shared<Node>();
+		return make_pooled<Node>();
 	}
 
 	const std::shared_ptr<Node> parent() const {
@@ -51,11 +72,22 @@ public:
         return m_children;
     }
 
+    const Node* root_node() const {
+        const Node* node = this;
+        for (auto parent = node->parent(); parent; parent = node->parent()) {
+            node = parent.get();
+        }
+        return node;
+    }
+
     void add_child(const std::shared_ptr<Node>& node, bool world_position_stays = false) {
 
         if (node.get() == this) {
             throw std::invalid_argument("Cannot add self as child");
         }
+        if (node->m_transform_storage != m_transform_storage) {
+            throw std::invalid_argument("Cannot add a child from another transform storage");
+        }
         if (node->parent()) {
             node->parent()->remove_child(node);
         }
@@ -67,15 +99,17 @@ public:
             auto world_rotation = node->world_rotation();
             auto world_scale = node->world_scale();
             node->m_parent = shared_from_this();
+            m_transform_storage->set_parent(node->m_transform_index, m_transform_index);
             node->set_world_position(world_position);
             node->set_world_rotation(world_rotation);
             node->set_world_scale(world_scale);
 
         } else {
             node->m_parent = shared_from_this();
+            m_transform_storage->set_parent(node->m_transform_index, m_transform_index);
         }
 
-        node->set_dirty();
+        s_hierarchy_version.fetch_add(1, std::memory_order_relaxed);
 
     }
 
@@ -84,67 +118,61 @@ public:
         if (it != m_children.end()) {
             m_children.erase(it);
             node->m_parent.reset();
-            node->set_dirty();
+            m_transform_storage->set_parent(node->m_transform_index, Transform_storage::invalid_index);
+            s_hierarchy_version.fetch_add(1, std::memory_order_relaxed);
         } else {
             throw std::invalid_argument("Node is not a child");	
         }
     }
 
     void set_position(const glm::vec3& pos) {
-        m_position = pos;
-        set_dirty();
+        m_transform_storage->set_position(m_transform_index, pos);
     }
 
     void set_world_position(const glm::vec3& pos) {
         if (parent()) {
-            m_position = pos - parent()->world_position();	
+            set_position(pos - parent()->world_position());	
         } else {
-            m_position = pos;	
+            set_position(pos);	
         }
-        set_dirty();
     }
 
     void set_rotation(const glm::quat& rot) {
-        m_rotation = rot;
-        set_dirty();
+        m_transform_storage->set_rotation(m_transform_index, rot);
     }
 
     void set_rotation_euler(const glm::vec3& rot) {
-        m_rotation = glm::quat(glm::radians(rot));
-        set_dirty();	
+        set_rotation(glm::quat(glm::radians(rot)));
     }
 
     void set_world_rotation(const glm::quat& rot) {
         if (parent()) {
-            m_rotation = rot * glm::inverse(parent()->world_rotation());	
+            set_rotation(rot * glm::inverse(parent()->world_rotation()));	
         }	
-        set_dirty();
     }
 
     void set_scale(const glm::vec3& scale) {
-        m_scale = scale;
-        set_dirty();
+        m_transform_storage->set_scale(m_transform_index, scale);
     }
 
     void set_world_scale(const glm::vec3& scale) {
         if (parent()) {
-            m_scale = scale / parent()->world_scale();	
+            set_scale(scale / parent()->world_scale());	
         } else {
-            m_scale = scale;
+            set_scale(scale);
         }
-        set_dirty();
     }
 
-    glm::vec3 position() const { return m_position; }
-    glm::quat rotation() const { return m_rotation; }
-    glm::vec3 scale() const { return m_scale; }
-	glm::vec3 rotation_euler() const { return glm::degrees(glm::eulerAngles(m_rotation)); }
-	glm::vec3 up() const { return m_rotation * glm::vec3(0.0f, 1.0f, 0.0f); }
-    glm::vec3 down() const { return m_rotation * glm::vec3(0.0f, -1.0f, 0.0f); }
-    glm::vec3 right() const { return m_rotation * glm::vec3(1.0f, 0.0f, 0.0f); }
-	glm::vec3 left() const { return m_rotation * glm::vec3(-1.0f, 0.0f, 0.0f); }
-	glm::vec3 front() const { return m_rotation * glm::vec3(0.0f, 0.0f, 1.0f); }
-    glm::vec3 back() const { return m_rotation * glm::vec3(0.0f, 0.0f, -1.0f); }
+    glm::vec3 position() const { return m_transform_storage->position(m_transform_index); }
+    glm::quat rotation() const { return m_transform_storage->rotation(m_transform_index); }
+    glm::vec3 scale() const { return m_transform_storage->scale(m_transform_index); }
+	glm::vec3 rotation_euler() const { return glm::degrees(glm::eulerAngles(rotation())); }
+	glm::vec3 up() const { return rotation() * glm::vec3(0.0f, 1.0f, 0.0f); }
+    glm::vec3 down() const { return rotation() * glm::vec3(0.0f, -1.0f, 0.0f); }
+    glm::vec3 right() const { return rotation() * glm::vec3(1.0f, 0.0f, 0.0f); }
+	glm::vec3 left() const { return rotation() * glm::vec3(-1.0f, 0.0f, 0.0f); }
+	glm::vec3 front() const { return rotation() * glm::vec3(0.0f, 0.0f, 1.0f); }
+    glm::vec3 back() const { return rotation() * glm::vec3(0.0f, 0.0f, -1.0f); }
 
     glm::vec3 world_up() { return world_rotation() * glm::vec3(0.0f, 1.0f, 0.0f); }
     glm::vec3 world_down() { return world_rotation() * glm::vec3(0.0f, -1.0f, 0.0f); }
@@ -158,26 +186,7 @@ public:
     glm::mat4 normal_matrix() { return glm::transpose(glm::inverse(model_matrix())); }
 
     glm::mat4 model_matrix()  {
-
-        if (!m_is_dirty) {
-            return m_model_matrix;
-        }
-
-        m_is_dirty = false;
-
-        glm::mat4 parent_matrix = glm::identity<glm::mat4>();
-
-        if (parent()) {
-            parent_matrix = parent()->model_matrix();
-        }
-
-        glm::mat4 transform = glm::identity<glm::mat4>();
-
-        transform = glm::scale(transform, m_scale);
-        transform *= glm::mat4_cast(m_rotation);
-        transform = glm::translate(glm::identity<glm::mat4>(), m_position) * transform;
-        
-        return m_model_matrix = parent_matrix * transform;
+        return m_transform_storage->world_matrix(m_transform_index);
     }
 
     void set_local_model_matrix(const glm::mat4& local_model_matrix) {
@@ -197,36 +206,28 @@ public:
         set_position(position);
         set_rotation(rotation);
         set_scale(scale);
-
-        m_is_dirty = true;
     }
 
     void set_dirty() { 
-        if (m_is_dirty) {
-            return;	
-        }
-
-        m_is_dirty = true; 
-        for (auto& child : m_children) {
-            child->set_dirty();	
-        }
+        m_transform_storage->mark_dirty(m_transform_index);
     }
 
 	glm::vec3 world_scale() {
+        const auto& model_matrix = m_transform_storage->world_matrix(m_transform_index);
         return glm::vec3(
-			glm::length(glm::vec3(model_matrix()[0])),
-			 glm::length(glm::vec3(model_matrix()[1])), 
-			 glm::length(glm::vec3(model_matrix()[2]))
+			glm::length(glm::vec3(model_matrix[0])),
+			 glm::length(glm::vec3(model_matrix[1])), 
+			 glm::length(glm::vec3(model_matrix[2]))
 			);
     }
 
     glm::vec3 world_position() {
-        return glm::vec3(model_matrix()[3]);
+        return glm::vec3(m_transform_storage->world_matrix(m_transform_index)[3]);
     }
 
     glm::quat world_rotation() {
 		auto scale = world_scale();
-		auto model_matrix = glm::mat3(this->model_matrix());
+		auto model_matrix = glm::mat3(m_transform_storage->world_matrix(m_transform_index));
 		model_matrix[0] /= scale.x;
 		model_matrix[1] /= scale.y;
 		model_matrix[2] /= scale.z;
@@ -251,7 +252,7 @@ public:
         if (glm::length(glm::cross(current_front, direction)) < EPSILON) {
             // 如果它们是相反方向，则绕 up 轴旋转 180 度
             if (glm::dot(current_front, direction) < 0) {
-                m_rotation = glm::rotate(m_rotation, glm::radians(180.0f), up());
+                set_rotation(glm::rotate(rotation(), glm::radians(180.0f), up()));
             }
             return;
         }
@@ -259,7 +260,7 @@ public:
         // 计算旋转四元数：从 current_front 旋转到 direction
         glm::quat rotation_quat = glm::rotation(current_front, direction);
 
-        set_rotation(glm::normalize(rotation_quat * m_rotation)); 
+        set_rotation(glm::normalize(rotation_quat * rotation())); 
     }
 
     void look_at_point(const glm::vec3& target_point) {
@@ -268,12 +269,12 @@ public:
     }
 
     void translate(const glm::vec3 &direction, float distance) {
-        set_position(m_position + direction * distance);
+        set_position(position() + direction * distance);
     }
 
     void rotate(float angle, const glm::vec3& axis) {
         glm::quat rotation = glm::angleAxis(glm::radians(angle), axis);  // Convert angle-axis to quaternion
-        set_rotation(rotation * m_rotation);  // Apply rotation to current rotation
+        set_rotation(rotation * this->rotation());  // Apply rotation to current rotation
     }
 	
 };
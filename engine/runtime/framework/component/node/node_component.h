@@ -24,6 +24,11 @@ public:
     void on_add_to_game_object() override { 
         m_node = Node::create();
     }
+
+    // the transform and parent are set by the prefab
+    std::shared_ptr<Base_component> clone() const override {
+        return make_pooled<Node_component>();
+    }
 };
 
 };
@@ -0,0 +1,351 @@
+#pragma once
+
+#include "engine/runtime/tool/math.h"
+#include "glm/fwd.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace rtr {
+
+// Structure-of-arrays storage for node transforms. Every Node owns one slot; local
+// TRS, parent slot and cached world matrix live in parallel contiguous arrays.
+//
+// World matrices are versioned instead of dirty-flagged: a slot's world matrix is
+// valid while its local version and its parent's world version are the ones it
+// was computed from. world_matrix() refreshes a single slot lazily by walking up
+// the parent slots, update_world_matrices() refreshes everything in one linear
+// pass over the slots sorted so parents come before their children, composing the
+// changed local matrices with the batched SIMD kernels of tool/math.h. Owners of a
+// subset of the slots, like a scene sharing the storage with others, refresh just
+// theirs with an update order from sort_update_order().
+//
+// Slots of different hierarchies can be read and refreshed from different threads,
+// allocating, releasing and reparenting must not overlap with any other access.
+class Transform_storage {
+public:
+    static constexpr uint32_t invalid_index = std::numeric_limits<uint32_t>::max();
+
+private:
+    std::vector<glm::vec3> m_positions{};
+    std::vector<glm::quat> m_rotations{};
+    std::vector<glm::vec3> m_scales{};
+    std::vector<uint32_t> m_parents{};
+    std::vector<glm::mat4> m_world_matrices{};
+
+    std::vector<uint32_t> m_local_versions{};
+    std::vector<uint32_t> m_world_versions{};
+    std::vector<uint32_t> m_computed_local_versions{};
+    std::vector<uint32_t> m_computed_parent_versions{};
+
+    std::vector<uint8_t> m_is_alive{};
+    std::vector<uint32_t> m_free_indices{};
+
+    std::vector<uint32_t> m_update_order{};
+    bool m_is_update_order_dirty{true};
+
+    // scratch of update_world_matrices, kept to avoid reallocating every frame
+    std::vector<uint8_t> m_is_changed{};
+    std::vector<uint32_t> m_changed_indices{};
+    std::vector<glm::vec3> m_changed_positions{};
+    std::vector<glm::quat> m_changed_rotations{};
+    std::vector<glm::vec3> m_changed_scales{};
+    std::vector<glm::mat4> m_changed_local_matrices{};
+
+public:
+    Transform_storage() = default;
+    ~Transform_storage() = default;
+
+    Transform_storage(const Transform_storage&) = delete;
+    Transform_storage& operator=(const Transform_storage&) = delete;
+
+    static std::shared_ptr<Transform_storage> create() {
+        return std::make_shared<Transform_storage>();
+    }
+
+    // Storage new nodes are allocated from on the calling thread; the process wide
+    // default unless a Scope has bound another one.
+    static std::shared_ptr<Transform_storage> current() {
+        if (auto& bound = bound_storage()) {
+            return bound;
+        }
+        return default_storage();
+    }
+
+    class Scope {
+    private:
+        std::shared_ptr<Transform_storage> m_previous{};
+
+    public:
+        Scope(const std::shared_ptr<Transform_storage>& storage) : m_previous(bound_storage()) {
+            bound_storage() = storage;
+        }
+
+        ~Scope() {
+            bound_storage() = m_previous;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    uint32_t allocate() {
+        uint32_t index{};
+        if (!m_free_indices.empty()) {
+            index = m_free_indices.back();
+            m_free_indices.pop_back();
+        } else {
+            index = static_cast<uint32_t>(m_positions.size());
+            m_positions.emplace_back();
+            m_rotations.emplace_back();
+            m_scales.emplace_back();
+            m_parents.emplace_back();
+            m_world_matrices.emplace_back();
+            m_local_versions.emplace_back();
+            m_world_versions.emplace_back();
+            m_computed_local_versions.emplace_back();
+            m_computed_parent_versions.emplace_back();
+            m_is_alive.emplace_back();
+        }
+
+        m_positions[index] = glm::zero<glm::vec3>();
+        m_rotations[index] = glm::identity<glm::quat>();
+        m_scales[index] = glm::one<glm::vec3>();
+        m_parents[index] = invalid_index;
+        m_world_matrices[index] = glm::identity<glm::mat4>();
+        m_is_alive[index] = 1;
+        // differs from the computed version, so the first read computes the matrix
+        m_local_versions[index] = m_computed_local_versions[index] + 1;
+
+        m_is_update_order_dirty = true;
+        return index;
+    }
+
+    void release(uint32_t index) {
+        m_is_alive[index] = 0;
+        m_parents[index] = invalid_index;
+        m_free_indices.push_back(index);
+        m_is_update_order_dirty = true;
+    }
+
+    std::size_t size() const { return m_positions.size() - m_free_indices.size(); }
+
+    const glm::vec3& position(uint32_t index) const { return m_positions[index]; }
+    const glm::quat& rotation(uint32_t index) const { return m_rotations[index]; }
+    const glm::vec3& scale(uint32_t index) const { return m_scales[index]; }
+    uint32_t parent(uint32_t index) const { return m_parents[index]; }
+
+    void set_position(uint32_t index, const glm::vec3& position) {
+        m_positions[index] = position;
+        m_local_versions[index]++;
+    }
+
+    void set_rotation(uint32_t index, const glm::quat& rotation) {
+        m_rotations[index] = rotation;
+        m_local_versions[index]++;
+    }
+
+    void set_scale(uint32_t index, const glm::vec3& scale) {
+        m_scales[index] = scale;
+        m_local_versions[index]++;
+    }
+
+    void set_parent(uint32_t index, uint32_t parent) {
+        m_parents[index] = parent;
+        m_local_versions[index]++;
+        m_is_update_order_dirty = true;
+    }
+
+    void mark_dirty(uint32_t index) {
+        m_local_versions[index]++;
+    }
+
+    glm::mat4 local_matrix(uint32_t index) const {
+        return simd::compose_trs(m_positions[index], m_rotations[index], m_scales[index]);
+    }
+
+    const glm::mat4& world_matrix(uint32_t index) {
+        if (m_parents[index] != invalid_index) {
+            world_matrix(m_parents[index]);
+        }
+        refresh(index);
+        return m_world_matrices[index];
+    }
+
+    // world matrix as of the last refresh, without checking for changes
+    const glm::mat4& cached_world_matrix(uint32_t index) const {
+        return m_world_matrices[index];
+    }
+
+    // bumped every time the slot's world matrix is recomputed
+    uint32_t world_version(uint32_t index) const {
+        return m_world_versions[index];
+    }
+
+    // Adds the ancestors missing from indices, drops duplicates and sorts them so
+    // parents come before their children. Stays valid until slots are allocated,
+    // released or reparented.
+    void sort_update_order(std::vector<uint32_t>& indices) const {
+        std::vector<uint8_t> is_listed(m_positions.size(), 0);
+        std::vector<uint32_t> slots{};
+        slots.reserve(indices.size());
+        for (auto index : indices) {
+            for (; index != invalid_index && !is_listed[index]; index = m_parents[index]) {
+                is_listed[index] = 1;
+                slots.push_back(index);
+            }
+        }
+        sort_by_depth(slots, indices);
+    }
+
+    void update_world_matrices() {
+        if (m_is_update_order_dirty) {
+            build_update_order();
+        }
+        update_world_matrices(m_update_order);
+    }
+
+    // Finds the slots of update_order whose world matrix changes, composes their local
+    // matrices in one SIMD batch and then chains them onto their parents in depth order.
+    void update_world_matrices(std::span<const uint32_t> update_order) {
+        collect_changed_indices(update_order);
+        auto count = m_changed_indices.size();
+        if (count == 0) {
+            return;
+        }
+
+        m_changed_positions.resize(count);
+        m_changed_rotations.resize(count);
+        m_changed_scales.resize(count);
+        m_changed_local_matrices.resize(count);
+        for (std::size_t i = 0; i < count; i++) {
+            auto index = m_changed_indices[i];
+            m_changed_positions[i] = m_positions[index];
+            m_changed_rotations[i] = m_rotations[index];
+            m_changed_scales[i] = m_scales[index];
+        }
+        simd::compose_trs(
+            m_changed_positions.data(),
+            m_changed_rotations.data(),
+            m_changed_scales.data(),
+            m_changed_local_matrices.data(),
+            count
+        );
+
+        for (std::size_t i = 0; i < count; i++) {
+            auto index = m_changed_indices[i];
+            auto parent = m_parents[index];
+            if (parent != invalid_index) {
+                simd::multiply(&m_world_matrices[parent], &m_changed_local_matrices[i], &m_world_matrices[index], 1);
+                m_computed_parent_versions[index] = m_world_versions[parent];
+            } else {
+                m_world_matrices[index] = m_changed_local_matrices[i];
+            }
+            m_computed_local_versions[index] = m_local_versions[index];
+            m_world_versions[index]++;
+            m_is_changed[index] = 0;
+        }
+    }
+
+private:
+    static std::shared_ptr<Transform_storage>& default_storage() {
+        static auto storage = std::make_shared<Transform_storage>();
+        return storage;
+    }
+
+    static std::shared_ptr<Transform_storage>& bound_storage() {
+        static thread_local std::shared_ptr<Transform_storage> storage{};
+        return storage;
+    }
+
+    // the parent must already be up to date
+    void refresh(uint32_t index) {
+        auto parent = m_parents[index];
+        bool is_local_stale = m_computed_local_versions[index] != m_local_versions[index];
+        bool is_parent_stale = parent != invalid_index && m_computed_parent_versions[index] != m_world_versions[parent];
+
+        if (!is_local_stale && !is_parent_stale) {
+            return;
+        }
+
+        if (parent != invalid_index) {
+            auto local = local_matrix(index);
+            simd::multiply(&m_world_matrices[parent], &local, &m_world_matrices[index], 1);
+            m_computed_parent_versions[index] = m_world_versions[parent];
+        } else {
+            m_world_matrices[index] = local_matrix(index);
+        }
+
+        m_computed_local_versions[index] = m_local_versions[index];
+        m_world_versions[index]++;
+    }
+
+    // Slots in update order whose local transform changed or whose parent changes or
+    // was refreshed since. Parents come first, so their flag is already known.
+    void collect_changed_indices(std::span<const uint32_t> update_order) {
+        m_is_changed.resize(m_positions.size(), 0);
+        m_changed_indices.clear();
+
+        for (auto index : update_order) {
+            auto parent = m_parents[index];
+            bool is_changed = m_computed_local_versions[index] != m_local_versions[index];
+            if (!is_changed && parent != invalid_index) {
+                is_changed = m_is_changed[parent] || m_computed_parent_versions[index] != m_world_versions[parent];
+            }
+            if (is_changed) {
+                m_is_changed[index] = 1;
+                m_changed_indices.push_back(index);
+            }
+        }
+    }
+
+    void build_update_order() {
+        std::vector<uint32_t> slots{};
+        slots.reserve(size());
+        for (uint32_t index = 0; index < m_positions.size(); index++) {
+            if (m_is_alive[index]) {
+                slots.push_back(index);
+            }
+        }
+        sort_by_depth(slots, m_update_order);
+        m_is_update_order_dirty = false;
+    }
+
+    // counting sort of slots by hierarchy depth
+    void sort_by_depth(const std::vector<uint32_t>& slots, std::vector<uint32_t>& order) const {
+        std::vector<uint32_t> depths(m_positions.size(), invalid_index);
+        uint32_t max_depth = 0;
+        for (auto index : slots) {
+            max_depth = std::max(max_depth, depth_of(index, depths));
+        }
+
+        std::vector<uint32_t> offsets(max_depth + 2, 0);
+        for (auto index : slots) {
+            offsets[depths[index] + 1]++;
+        }
+        for (uint32_t depth = 1; depth < offsets.size(); depth++) {
+            offsets[depth] += offsets[depth - 1];
+        }
+
+        order.assign(slots.size(), invalid_index);
+        for (auto index : slots) {
+            order[offsets[depths[index]]++] = index;
+        }
+    }
+
+    uint32_t depth_of(uint32_t index, std::vector<uint32_t>& depths) const {
+        if (depths[index] != invalid_index) {
+            return depths[index];
+        }
+        auto parent = m_parents[index];
+        return depths[index] = parent == invalid_index ? 0 : depth_of(parent, depths) + 1;
+    }
+
+};
+
+}
@@ -6,6 +6,7 @@
 #include "engine/runtime/framework/component/light/light_component.h"
 #include "engine/runtime/framework/component/node/node.h"
 #include "engine/runtime/framework/component/shadow_caster/shadow_caster.h"
+#include "engine/runtime/tool/math.h"
 #include "glm/ext/matrix_clip_space.hpp"
 #include "glm/ext/matrix_transform.hpp"
 #include "glm/fwd.hpp"
@@ -150,8 +151,7 @@ public:
     }
 
     std::vector<glm::vec3> generate_csm_frustum_vertices(float near, float far) {
-        std::vector<glm::vec3> vertices{};
-        const auto ndc_vertices = std::vector<glm::vec3>{
+        static const glm::vec3 ndc_vertices[8] = {
             {1.0f, 1.0f, 1.0f},
             {-1.0f, 1.0f, 1.0f},
             {-1.0f, -1.0f, 1.0f},
@@ -162,10 +162,16 @@ public:
             {1.0f, -1.0f, -1.0f}
         };
 
-        for (const auto& ndc : ndc_vertices) {
-            vertices.push_back(ndc_to_world(ndc, near, far));
-        }
+        auto projection_matrix = glm::perspective(
+            glm::radians(m_main_camera->fov()),
+            m_main_camera->aspect_ratio(),
+            near,
+            far
+        );
+        auto inverse_view_projection = glm::inverse(projection_matrix * m_main_camera->view_matrix());
 
+        std::vector<glm::vec3> vertices(8);
+        simd::project_points(inverse_view_projection, ndc_vertices, vertices.data(), vertices.size());
         return vertices;
     }
 
@@ -193,10 +199,13 @@ public:
                 glm::vec3(0, 1, 0)
             );
 
-            std::vector<glm::vec3> light_space_frustum_vertices{};
-            for (auto &vertex : csm_frustum_vertices) {
-                light_space_frustum_vertices.push_back(view_matrix * glm::vec4(vertex, 1.0f));
-            }
+            std::vector<glm::vec3> light_space_frustum_vertices(csm_frustum_vertices.size());
+            simd::transform_points(
+                view_matrix,
+                csm_frustum_vertices.data(),
+                light_space_frustum_vertices.data(),
+                csm_frustum_vertices.size()
+            );
 
             float min_x = std::numeric_limits<float>::max();
             float max_x = std::numeric_limits<float>::lowest();
@@ -230,6 +239,9 @@ public:
         m_directional_light = get_component<Directional_light_component>()->directional_light();
     }
 
+    // follows the main camera, which belongs to another game object
+    bool is_parallel_tick_safe() const override { return false; }
+
     void tick(const Logic_tick_context& tick_context) override {
 
         update();
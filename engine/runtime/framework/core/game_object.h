@@ -1,6 +1,10 @@
 #pragma once
 
 #include "engine/runtime/framework/component/component.h"
+#include "engine/runtime/tool/pool_allocator.h"
+#include <atomic>
+#include <cstdint>
+#include <limits>
 #include <memory>
 
 namespace rtr {
@@ -10,13 +14,19 @@ class Game_object : public std::enable_shared_from_this<Game_object>{
 protected:
     std::string m_name{};
     std::shared_ptr<Component_list> m_component_list{};
+
+    bool m_is_static{false};
+    // static version of the scene the object was added to, maintained by the scene;
+    // bumped whenever the object turns static or dynamic or changes while static, so
+    // only that scene rebuilds its static render list
+    std::atomic<uint64_t>* m_scene_static_version{nullptr};
     
 public:
 
-    Game_object(const std::string& name) : m_name(name), m_component_list(std::make_shared<Component_list>()) {}
+    Game_object(const std::string& name) : m_name(name), m_component_list(make_pooled<Component_list>()) {}
 
     static std::shared_ptr<Game_object> create(const std::string& name) {
-        return std::make_shared<Game_object>(name);
+        return make_pooled<Game_object>(name);
     }
 
     virtual ~Game_object() = default;
@@ -24,6 +34,31 @@ public:
 
     const std::shared_ptr<Component_list>& component_list() const { return m_component_list; }
 
+    // kept on the component list, so the scene can tell the owner of a component
+    const Game_object_handle& scene_handle() const { return m_component_list->scene_handle(); }
+    void set_scene_handle(const Game_object_handle& handle) { m_component_list->set_scene_handle(handle); }
+
+    void set_scene_static_version(std::atomic<uint64_t>* static_version) { m_scene_static_version = static_version; }
+
+    // Static objects are ticked once; the render records and lights they emit are
+    // replayed every frame until mark_static_dirty() is called. Cameras, shadow
+    // casters and scripts that must run every frame belong on dynamic objects.
+    bool is_static() const { return m_is_static; }
+
+    void set_static(bool is_static) {
+        if (m_is_static != is_static) {
+            m_is_static = is_static;
+            bump_scene_static_version();
+        }
+    }
+
+    // call after moving or editing a static object
+    void mark_static_dirty() {
+        if (m_is_static) {
+            bump_scene_static_version();
+        }
+    }
+
 	template<typename T> 
     std::shared_ptr<T> get_component() {
         return m_component_list->get_component<T>();
@@ -44,7 +79,7 @@ public:
 
     template<typename T>
     std::shared_ptr<T> add_component() {
-        auto component = std::make_shared<T>();
+        auto component = make_pooled<T>();
         if (component == nullptr) {
             std::cerr << "Failed to create component of type: " << typeid(T).name() << std::endl;
             return nullptr;
@@ -60,20 +95,35 @@ public:
         m_component_list->remove_component<T>();
     }
 
+    bool is_parallel_tick_safe() const {
+        for (auto& component : m_component_list->components()) {
+            if (!component->is_parallel_tick_safe()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // the order is cached, this only re-sorts after components or priorities changed
     void sort_components() {
-        m_component_list->sort_components([](const std::shared_ptr<Base_component>& a, const std::shared_ptr<Base_component>& b) {
-            return a->priority() < b->priority();
-        });
+        m_component_list->sorted_components();
     }
 
 	void tick(const Logic_tick_context& tick_context) {
-		sort_components();
-		for (auto& component : m_component_list->components()) {
-			if (component->is_enabled()) {
+		for (auto& component : m_component_list->sorted_components()) {
+			if (component->is_enabled() && !component->is_tick_batched()) {
 				component->tick(tick_context);
 			}
 		}
 	}
+
+protected:
+    // objects outside a scene need none, adding them rebuilds the scene's lists anyway
+    void bump_scene_static_version() {
+        if (m_scene_static_version) {
+            m_scene_static_version->fetch_add(1, std::memory_order_relaxed);
+        }
+    }
     
 };
 
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "engine/runtime/framework/component/node/node_component.h"
+#include "engine/runtime/framework/core/game_object.h"
+#include "engine/runtime/framework/plugin/model_loader.h"
+#include "engine/runtime/tool/pool_allocator.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace rtr {
+
+// A game object hierarchy captured as a template. Instantiating it clones the
+// captured components and local transforms into new game objects; geometry,
+// materials and textures are shared with the template, not copied.
+class Prefab {
+public:
+    static constexpr uint32_t invalid_index = std::numeric_limits<uint32_t>::max();
+
+private:
+    struct Template_object {
+        std::string name{};
+        // into m_objects, always before this object
+        uint32_t parent_index{invalid_index};
+        bool is_static{false};
+        bool has_node{false};
+        // detached clones, Node_component first so the others find it when attached
+        std::vector<std::shared_ptr<Base_component>> components{};
+    };
+
+    std::string m_name{};
+    std::vector<Template_object> m_objects{};
+
+    // local transforms per template object, identity for objects without a node
+    std::vector<glm::vec3> m_positions{};
+    std::vector<glm::quat> m_rotations{};
+    std::vector<glm::vec3> m_scales{};
+
+public:
+    // Captures game_objects and the node hierarchy between them; an object whose
+    // parent node is not in the list becomes a root. The objects are left untouched.
+    Prefab(const std::string& name, const std::vector<std::shared_ptr<Game_object>>& game_objects) : m_name(name) {
+        capture(game_objects);
+    }
+
+    static std::shared_ptr<Prefab> create(const std::string& name, const std::vector<std::shared_ptr<Game_object>>& game_objects) {
+        return std::make_shared<Prefab>(name, game_objects);
+    }
+
+    // loads the model once, the loaded game objects are dropped after the capture
+    static std::shared_ptr<Prefab> create(
+        const std::string& name,
+        const std::shared_ptr<Model>& model,
+        const std::shared_ptr<Base_model_loader>& model_loader
+    ) {
+        std::vector<std::shared_ptr<Game_object>> game_objects{};
+        model_loader->load_model(name, model, game_objects);
+        return create(name, game_objects);
+    }
+
+    const std::string& name() const { return m_name; }
+
+    // game objects per instance
+    std::size_t size() const { return m_objects.size(); }
+
+    // Appends one instance to game_objects, parents before children, and returns
+    // its first root. The objects are not added to any scene.
+    std::shared_ptr<Game_object> instantiate(std::vector<std::shared_ptr<Game_object>>& game_objects) const {
+        if (m_objects.empty()) {
+            return nullptr;
+        }
+
+        auto first = game_objects.size();
+        game_objects.reserve(first + m_objects.size());
+        std::vector<std::shared_ptr<Node>> nodes(m_objects.size());
+
+        for (std::size_t i = 0; i < m_objects.size(); i++) {
+            const auto& object = m_objects[i];
+            auto game_object = Game_object::create(object.name);
+
+            for (const auto& prototype : object.components) {
+                auto component = prototype->clone();
+                component->set_component_type_id(prototype->component_type_id());
+                component->set_enabled(prototype->is_enabled());
+                component->set_priority(prototype->priority());
+                game_object->add_component(component);
+            }
+
+            if (object.has_node) {
+                auto& node = nodes[i];
+                node = game_object->get_component<Node_component>()->node();
+                node->set_position(m_positions[i]);
+                node->set_rotation(m_rotations[i]);
+                node->set_scale(m_scales[i]);
+                if (object.parent_index != invalid_index) {
+                    nodes[object.parent_index]->add_child(node);
+                }
+            }
+
+            game_object->set_static(object.is_static);
+            game_objects.push_back(std::move(game_object));
+        }
+
+        return game_objects[first];
+    }
+
+private:
+    void capture(const std::vector<std::shared_ptr<Game_object>>& game_objects) {
+        std::unordered_map<const Node*, uint32_t> source_index_of{};
+        std::vector<std::shared_ptr<Node>> source_nodes(game_objects.size());
+        for (uint32_t i = 0; i < game_objects.size(); i++) {
+            if (auto node_component = game_objects[i]->get_component<Node_component>()) {
+                source_nodes[i] = node_component->node();
+                source_index_of.emplace(source_nodes[i].get(), i);
+            }
+        }
+
+        std::vector<uint32_t> source_parents(game_objects.size(), invalid_index);
+        for (uint32_t i = 0; i < game_objects.size(); i++) {
+            if (!source_nodes[i]) {
+                continue;
+            }
+            if (auto parent = source_nodes[i]->parent()) {
+                if (auto it = source_index_of.find(parent.get()); it != source_index_of.end()) {
+                    source_parents[i] = it->second;
+                }
+            }
+        }
+
+        // by depth, so every parent is instantiated before its children
+        std::vector<uint32_t> depths(game_objects.size(), 0);
+        for (uint32_t i = 0; i < game_objects.size(); i++) {
+            for (auto parent = source_parents[i]; parent != invalid_index; parent = source_parents[parent]) {
+                depths[i]++;
+            }
+        }
+        std::vector<uint32_t> order(game_objects.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+            return depths[lhs] < depths[rhs];
+        });
+
+        std::vector<uint32_t> template_index_of(game_objects.size());
+        for (uint32_t i = 0; i < order.size(); i++) {
+            template_index_of[order[i]] = i;
+        }
+
+        m_objects.reserve(order.size());
+        m_positions.reserve(order.size());
+        m_rotations.reserve(order.size());
+        m_scales.reserve(order.size());
+
+        for (auto source_index : order) {
+            const auto& source = game_objects[source_index];
+            const auto& source_node = source_nodes[source_index];
+
+            Template_object object{
+                .name = source->name(),
+                .parent_index = source_parents[source_index] == invalid_index ? invalid_index : template_index_of[source_parents[source_index]],
+                .is_static = source->is_static(),
+                .has_node = source_node != nullptr
+            };
+
+            const auto& components = source->component_list()->components();
+            object.components.reserve(components.size());
+            for (const auto& component : components) {
+                auto prototype = component->clone();
+                if (!prototype) {
+                    throw std::invalid_argument("Prefab: " + readable_type_name(typeid(*component)) + " of game object " + source->name() + " cannot be cloned");
+                }
+                prototype->set_component_type_id(component->component_type_id());
+                prototype->set_enabled(component->is_enabled());
+                prototype->set_priority(component->priority());
+                if (dynamic_cast<Node_component*>(component.get())) {
+                    object.components.insert(object.components.begin(), std::move(prototype));
+                } else {
+                    object.components.push_back(std::move(prototype));
+                }
+            }
+
+            if (source_node) {
+                const auto& storage = *source_node->transform_storage();
+                auto index = source_node->transform_index();
+                m_positions.push_back(storage.position(index));
+                m_rotations.push_back(storage.rotation(index));
+                m_scales.push_back(storage.scale(index));
+            } else {
+                m_positions.push_back(glm::vec3(0.0f));
+                m_rotations.push_back(glm::identity<glm::quat>());
+                m_scales.push_back(glm::vec3(1.0f));
+            }
+
+            m_objects.push_back(std::move(object));
+        }
+    }
+};
+
+}
@@ -1,43 +1,251 @@
 #pragma once
 
+#include "engine/runtime/framework/component/mesh_renderer/mesh_renderer_component.h"
+#include "engine/runtime/framework/component/node/node_component.h"
 #include "engine/runtime/framework/core/game_object.h"
+#include "engine/runtime/framework/core/prefab.h"
 #include "engine/runtime/framework/plugin/model_loader.h"
+#include "engine/runtime/framework/system/system_scheduler.h"
 #include "engine/runtime/function/render/material/shading/phong_material.h"
+#include "engine/runtime/tool/dynamic_bvh.h"
+#include "engine/runtime/tool/job_system.h"
+#include "engine/runtime/tool/math.h"
+#include "engine/runtime/tool/triangle_bvh.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace rtr {
+
+enum class Scene_tick_mode {
+    SERIAL,
+    PARALLEL
+};
+
+// leaf of a scene's spatial index, with what its world bounds were computed from
+struct Scene_spatial_object {
+    Game_object_handle handle{};
+    Mesh_renderer_component* renderer{};
+    const Geometry* geometry{};
+    uint32_t world_version{};
+};
+
+struct Scene_ray_hit {
+    std::shared_ptr<Game_object> game_object{};
+    // where the ray enters the world bounds, in multiples of the ray direction
+    float distance{};
+};
+
+struct Scene_raycast_hit {
+    // nullptr when nothing was hit
+    std::shared_ptr<Game_object> game_object{};
+    // into the triangles of the hit geometry, see Triangle_hit
+    uint32_t triangle_index{};
+    // in world space
+    Triangle triangle{};
+    // in multiples of the ray direction
+    float distance{};
+
+    bool is_hit() const { return game_object != nullptr; }
+};
     
 class Scene {
 
 protected:
+    struct Game_object_slot {
+        uint32_t dense_index{Game_object_handle::invalid_index};
+        uint32_t generation{0};
+    };
+
     std::string m_name{};
+    // game objects are kept dense for ticking; handles address slots that point into
+    // the dense array, so lookup and swap-and-pop removal are O(1)
     std::vector<std::shared_ptr<Game_object>> m_game_objects{};
+    std::vector<uint32_t> m_dense_slots{};
+    std::vector<Game_object_slot> m_slots{};
+    std::vector<uint32_t> m_free_slots{};
+
+    bool m_is_name_index_enabled{true};
+    std::unordered_multimap<std::string, Game_object_handle> m_name_index{};
+
     std::shared_ptr<Skybox> m_skybox{};
+
+    // reused by instantiate()
+    std::vector<std::shared_ptr<Game_object>> m_instantiate_buffer{};
+
+    Scene_tick_mode m_tick_mode{Scene_tick_mode::SERIAL};
+
+    // game objects split by Game_object::is_static(); only the dynamic ones tick
+    // every frame, the static ones only when their render list is rebuilt
+    bool m_is_object_list_dirty{true};
+    // bumped by the game objects of this scene, see Game_object::mark_static_dirty
+    std::atomic<uint64_t> m_static_version{0};
+    uint64_t m_object_list_static_version{};
+    std::vector<Game_object*> m_dynamic_objects{};
+    std::vector<Game_object*> m_static_objects{};
+    std::shared_ptr<const Static_render_list> m_static_render_list{};
+    bool m_is_static_render_list_dirty{true};
+
+    // parallel tick partitions: game objects sharing a node hierarchy always land in
+    // the same chunk, so no two workers ever touch the same transform chain
+    bool m_is_tick_partition_dirty{true};
+    uint64_t m_tick_partition_hierarchy_version{};
+    std::vector<Game_object*> m_parallel_tick_objects{};
+    std::vector<std::size_t> m_parallel_tick_chunk_offsets{};
+    std::vector<Game_object*> m_serial_tick_objects{};
+    std::vector<Swap_data> m_swap_data_shards{};
+
+    // incremental mode: the mesh renderers the render side knows about, with the world
+    // version of the model matrix it was last sent
+    struct Published_render_object {
+        uint32_t object_id{};
+        uint32_t transform_index{};
+        uint32_t world_version{};
+    };
+    std::vector<Published_render_object> m_published_render_objects{};
+    std::unordered_map<uint32_t, uint32_t> m_published_index_of{};
+    std::vector<uint32_t> m_pending_render_removals{};
+
+    // transforms of the nodes in this scene, captured from the storage current at construction
+    std::shared_ptr<Transform_storage> m_transform_storage{Transform_storage::current()};
+    // the slots of this scene's nodes and their ancestors, parents first; the world
+    // matrices are refreshed over these only, not over other scenes sharing the storage
+    std::vector<uint32_t> m_transform_update_order{};
+    uint64_t m_transform_update_order_registry_version{};
+    uint64_t m_transform_update_order_hierarchy_version{};
+
+    // every component of the scene's game objects, grouped by type
+    Component_registry m_component_registry{};
+
+    // runs component_tick_system_name first, then the added systems
+    System_scheduler m_system_scheduler{};
+    uint64_t m_batched_graph_version{};
+    std::vector<uint32_t> m_batched_component_types{};
+
+    // world bounds of every mesh renderer with geometry; moves refit the tree, the
+    // tree is checked for a rebalance every spatial_rebalance_interval ticks
+    Dynamic_bvh<Scene_spatial_object> m_spatial_index{};
+    std::size_t m_spatial_index_ticks{};
     
 public:
-    Scene(const std::string& name) : m_name(name) {}
+    static constexpr std::size_t spatial_rebalance_interval = 32;
+
+    // the system calling Base_component::tick of every dynamic game object; exclusive,
+    // so it runs before all systems added to the scene
+    inline static const std::string component_tick_system_name{"component_tick"};
+
+    Scene(const std::string& name) : m_name(name) {
+        m_component_registry.set_remove_callback(
+            Component_type_index::of<Mesh_renderer_component>(),
+            [this](Base_component& component) {
+                auto& renderer = static_cast<Mesh_renderer_component&>(component);
+                unpublish_renderer(renderer);
+                unindex_renderer(renderer);
+            }
+        );
+        m_system_scheduler.add_system(Function_system::create(
+            component_tick_system_name,
+            System_access{}.exclusive(),
+            [this](const System_tick_context& tick_context) { tick_components(tick_context.logic_tick_context); }
+        ));
+    }
     static std::shared_ptr<Scene> create(const std::string& name) {
         return std::make_shared<Scene>(name);
     }
 
-    virtual ~Scene() = default;
+    virtual ~Scene() {
+        clear();
+    }
     const std::string& name() const { return m_name; }
     void set_skybox(const std::shared_ptr<Skybox>& skybox) { 
         m_skybox = skybox; 
     }
     const std::shared_ptr<Skybox>& skybox() const { return m_skybox; }
 
+    const std::shared_ptr<Transform_storage>& transform_storage() const { return m_transform_storage; }
+
+    const Component_registry& component_registry() const { return m_component_registry; }
+
+    // visits every component in the scene whose dynamic type is exactly T
+    template<typename T, typename Func>
+    void for_each_component(Func&& func) const {
+        m_component_registry.for_each<T>(std::forward<Func>(func));
+    }
+
+    std::shared_ptr<Base_system> add_system(const std::shared_ptr<Base_system>& system) {
+        m_system_scheduler.add_system(system);
+        return system;
+    }
+
+    void remove_system(const std::string& name) {
+        m_system_scheduler.remove_system(name);
+    }
+
+    System_scheduler& system_scheduler() { return m_system_scheduler; }
+    const System_scheduler& system_scheduler() const { return m_system_scheduler; }
+
+    Scene_tick_mode tick_mode() const { return m_tick_mode; }
+    void set_tick_mode(Scene_tick_mode tick_mode) { m_tick_mode = tick_mode; }
+
     std::shared_ptr<Game_object> add_game_object(const std::shared_ptr<Game_object>& game_object) {
+        if (game_object->scene_handle().is_valid()) {
+            throw std::invalid_argument("Scene: game object " + game_object->name() + " already belongs to a scene");
+        }
+        // slots of another storage would be read and written against this one
+        for (const auto& component : game_object->component_list()->components()) {
+            if (component->component_type() != Component_type::NODE) {
+                continue;
+            }
+            const auto& node = static_cast<const Node_component&>(*component).node();
+            if (node && node->transform_storage() != m_transform_storage) {
+                throw std::invalid_argument("Scene: game object " + game_object->name() + " was created for another transform storage");
+            }
+        }
+
+        uint32_t slot_index{};
+        if (!m_free_slots.empty()) {
+            slot_index = m_free_slots.back();
+            m_free_slots.pop_back();
+        } else {
+            slot_index = static_cast<uint32_t>(m_slots.size());
+            m_slots.emplace_back();
+        }
+
+        auto& slot = m_slots[slot_index];
+        slot.dense_index = static_cast<uint32_t>(m_game_objects.size());
         m_game_objects.push_back(game_object);
+        m_dense_slots.push_back(slot_index);
+
+        Game_object_handle handle{slot_index, slot.generation};
+        game_object->set_scene_handle(handle);
+        game_object->set_scene_static_version(&m_static_version);
+        if (m_is_name_index_enabled) {
+            m_name_index.emplace(game_object->name(), handle);
+        }
+
+        game_object->component_list()->set_registry(&m_component_registry);
+        m_is_object_list_dirty = true;
         return game_object;
     }
 
     std::shared_ptr<Game_object> add_game_object(const std::string& name) {
-        auto game_object = Game_object::create(name);
-        m_game_objects.push_back(game_object);
-        return game_object;
+        return add_game_object(Game_object::create(name));
+    }
+
+    void reserve(std::size_t game_object_count) {
+        m_game_objects.reserve(game_object_count);
+        m_dense_slots.reserve(game_object_count);
+        m_slots.reserve(game_object_count);
+        if (m_is_name_index_enabled) {
+            m_name_index.reserve(game_object_count);
+        }
     }
 
     std::shared_ptr<Game_object> add_model(
@@ -51,15 +259,43 @@ public:
             model,
             gos
         );
+        reserve(m_game_objects.size() + gos.size());
         for (auto& go : gos) {
             add_game_object(go);
         }
         return root_go;
     }
 
+    // One copy of the prefab; reserve() ahead when placing many.
+    std::shared_ptr<Game_object> instantiate(const Prefab& prefab) {
+        m_instantiate_buffer.clear();
+        auto root = prefab.instantiate(m_instantiate_buffer);
+        for (auto& game_object : m_instantiate_buffer) {
+            add_game_object(game_object);
+        }
+        m_instantiate_buffer.clear();
+        return root;
+    }
+
+    // dense and unordered: removal moves the last game object into the freed place
     const std::vector<std::shared_ptr<Game_object>>& game_objects() const { return m_game_objects; }
-    
-    std::shared_ptr<Game_object> get_game_object(const std::string& name) {
+
+    bool is_alive(const Game_object_handle& handle) const {
+        return handle.index < m_slots.size() &&
+            m_slots[handle.index].generation == handle.generation &&
+            m_slots[handle.index].dense_index != Game_object_handle::invalid_index;
+    }
+
+    std::shared_ptr<Game_object> get_game_object(const Game_object_handle& handle) const {
+        return is_alive(handle) ? m_game_objects[m_slots[handle.index].dense_index] : nullptr;
+    }
+
+    // any game object with this name; hashed unless the name index is disabled
+    std::shared_ptr<Game_object> get_game_object(const std::string& name) const {
+        if (m_is_name_index_enabled) {
+            auto it = m_name_index.find(name);
+            return it != m_name_index.end() ? get_game_object(it->second) : nullptr;
+        }
         for (auto& game_object : m_game_objects) {
             if (game_object->name() == name) {
                 return game_object;
@@ -68,36 +304,589 @@ public:
         return nullptr;
     }
 
-    void remove_game_object(const std::string& name) {
-        for (auto it = m_game_objects.begin(); it != m_game_objects.end(); ++it) {
-            if ((*it)->name() == name) {
-                m_game_objects.erase(it);
-                return;
+    bool is_name_index_enabled() const { return m_is_name_index_enabled; }
+
+    // scenes that never look objects up by name can skip the index when spawning in bulk
+    void set_name_index_enabled(bool is_enabled) {
+        m_is_name_index_enabled = is_enabled;
+        m_name_index.clear();
+        if (is_enabled) {
+            m_name_index.reserve(m_game_objects.size());
+            for (auto& game_object : m_game_objects) {
+                m_name_index.emplace(game_object->name(), game_object->scene_handle());
             }
         }
     }
 
-    void remove_game_object(const std::shared_ptr<Game_object>& game_object) {
-        for (auto it = m_game_objects.begin(); it!= m_game_objects.end(); ++it) {
-            if ((*it) == game_object) {
-                m_game_objects.erase(it);
-                return;
+    void remove_game_object(const Game_object_handle& handle) {
+        if (!is_alive(handle)) {
+            return;
+        }
+
+        auto& slot = m_slots[handle.index];
+        auto dense_index = slot.dense_index;
+        auto game_object = m_game_objects[dense_index];
+
+        if (m_is_name_index_enabled) {
+            auto [begin, end] = m_name_index.equal_range(game_object->name());
+            for (auto it = begin; it != end; ++it) {
+                if (it->second == handle) {
+                    m_name_index.erase(it);
+                    break;
+                }
             }
         }
+
+        auto last_index = static_cast<uint32_t>(m_game_objects.size() - 1);
+        if (dense_index != last_index) {
+            m_game_objects[dense_index] = std::move(m_game_objects[last_index]);
+            m_dense_slots[dense_index] = m_dense_slots[last_index];
+            m_slots[m_dense_slots[dense_index]].dense_index = dense_index;
+        }
+        m_game_objects.pop_back();
+        m_dense_slots.pop_back();
+
+        slot.dense_index = Game_object_handle::invalid_index;
+        slot.generation++;
+        m_free_slots.push_back(handle.index);
+
+        game_object->component_list()->set_registry(nullptr);
+        game_object->set_scene_handle({});
+        game_object->set_scene_static_version(nullptr);
+        m_is_object_list_dirty = true;
+    }
+
+    void remove_game_object(const std::string& name) {
+        if (auto game_object = get_game_object(name)) {
+            remove_game_object(game_object->scene_handle());
+        }
+    }
+
+    void remove_game_object(const std::shared_ptr<Game_object>& game_object) {
+        if (game_object && get_game_object(game_object->scene_handle()) == game_object) {
+            remove_game_object(game_object->scene_handle());
+        }
     }
 
     void clear() {
+        for (auto& game_object : m_game_objects) {
+            game_object->component_list()->set_registry(nullptr);
+            game_object->set_scene_handle({});
+            game_object->set_scene_static_version(nullptr);
+        }
+        for (auto slot_index : m_dense_slots) {
+            m_slots[slot_index].dense_index = Game_object_handle::invalid_index;
+            m_slots[slot_index].generation++;
+            m_free_slots.push_back(slot_index);
+        }
         m_game_objects.clear();
+        m_dense_slots.clear();
+        m_name_index.clear();
+        m_is_object_list_dirty = true;
     }
 
     void tick(const Logic_tick_context& tick_context) {
-        tick_context.logic_swap_data.skybox = m_skybox;
+        if (m_is_object_list_dirty || m_object_list_static_version != m_static_version.load(std::memory_order_relaxed)) {
+            build_object_lists();
+        }
+        if (m_is_static_render_list_dirty) {
+            build_static_render_list(tick_context);
+        }
+
+        auto& data = tick_context.logic_swap_data;
+        data.skybox = m_skybox;
+        auto first_render_object = data.render_objects.size();
+        auto first_render_change = data.render_changes.size();
 
+        m_system_scheduler.prepare();
+        if (m_batched_graph_version != m_system_scheduler.graph_version()) {
+            update_batched_component_types();
+        }
+        m_system_scheduler.run(System_tick_context{*this, tick_context});
+
+        resolve_model_matrices(data, first_render_object);
+        if (data.is_incremental) {
+            journal_render_changes(data, first_render_change);
+        } else {
+            m_pending_render_removals.clear();
+        }
+        update_spatial_index();
+
+        if (m_static_render_list) {
+            data.static_render_list = m_static_render_list;
+            data.directional_lights.insert(data.directional_lights.end(), m_static_render_list->directional_lights.begin(), m_static_render_list->directional_lights.end());
+            data.point_lights.insert(data.point_lights.end(), m_static_render_list->point_lights.begin(), m_static_render_list->point_lights.end());
+            data.spot_lights.insert(data.spot_lights.end(), m_static_render_list->spot_lights.begin(), m_static_render_list->spot_lights.end());
+        }
+    }
+
+    const std::shared_ptr<const Static_render_list>& static_render_list() const { return m_static_render_list; }
+
+    // Spatial queries over the world bounds of the mesh renderers as of the last tick.
+    // The game objects found are appended, ray hits are appended nearest first.
+    const Dynamic_bvh<Scene_spatial_object>& spatial_index() const { return m_spatial_index; }
+
+    void query(const Bouding_box& box, std::vector<std::shared_ptr<Game_object>>& game_objects) const {
+        m_spatial_index.query(box, [&](uint32_t proxy) { append_spatial_object(proxy, game_objects); });
+    }
+
+    void query(const Sphere& sphere, std::vector<std::shared_ptr<Game_object>>& game_objects) const {
+        m_spatial_index.query(sphere, [&](uint32_t proxy) { append_spatial_object(proxy, game_objects); });
+    }
+
+    void query(const Frustum& frustum, std::vector<std::shared_ptr<Game_object>>& game_objects) const {
+        m_spatial_index.query(frustum, [&](uint32_t proxy) { append_spatial_object(proxy, game_objects); });
+    }
+
+    void query(const Ray& ray, float max_distance, std::vector<Scene_ray_hit>& hits) const {
+        auto first = hits.size();
+        m_spatial_index.raycast(ray, max_distance, [&](uint32_t proxy, float distance) {
+            if (auto game_object = get_game_object(m_spatial_index.payload(proxy).handle)) {
+                hits.push_back(Scene_ray_hit{std::move(game_object), distance});
+            }
+            return max_distance;
+        });
+        std::sort(hits.begin() + first, hits.end(), [](const Scene_ray_hit& lhs, const Scene_ray_hit& rhs) {
+            return lhs.distance < rhs.distance;
+        });
+    }
+
+    // Nearest triangle of the mesh renderers hit before max_distance, as of the last tick.
+    // The spatial index hands out the renderers whose bounds the ray enters, nearest
+    // first, and each is tested in object space against its Geometry::triangle_bvh();
+    // renderers entered beyond the closest hit so far are not tested.
+    Scene_raycast_hit raycast(const Ray& ray, float max_distance = std::numeric_limits<float>::max()) const {
+        const auto& storage = *m_transform_storage;
+        uint32_t hit_proxy = m_spatial_index.null_index;
+        Triangle_hit hit{};
+        glm::mat4 hit_world_matrix{};
+
+        m_spatial_index.raycast(ray, max_distance, [&](uint32_t proxy, float) {
+            const auto& mesh_renderer = m_spatial_index.payload(proxy).renderer->mesh_renderer();
+            const auto& geometry = mesh_renderer->geometry();
+            if (!geometry) {
+                return max_distance;
+            }
+
+            const auto& world_matrix = storage.cached_world_matrix(mesh_renderer->node()->transform_index());
+            auto inverse_world_matrix = glm::inverse(world_matrix);
+            // affine, so distances along the ray are the same in both spaces
+            Ray local_ray{
+                glm::vec3(inverse_world_matrix * glm::vec4(ray.origin, 1.0f)),
+                glm::vec3(inverse_world_matrix * glm::vec4(ray.direction, 0.0f))
+            };
+
+            Triangle_hit local_hit{};
+            if (geometry->triangle_bvh()->raycast(local_ray, max_distance, local_hit)) {
+                max_distance = local_hit.distance;
+                hit = local_hit;
+                hit_proxy = proxy;
+                hit_world_matrix = world_matrix;
+            }
+            return max_distance;
+        });
+
+        Scene_raycast_hit result{};
+        if (hit_proxy == m_spatial_index.null_index) {
+            return result;
+        }
+        result.game_object = get_game_object(m_spatial_index.payload(hit_proxy).handle);
+        result.triangle_index = hit.triangle_index;
+        result.triangle = Triangle(
+            glm::vec3(hit_world_matrix * glm::vec4(hit.triangle.v0, 1.0f)),
+            glm::vec3(hit_world_matrix * glm::vec4(hit.triangle.v1, 1.0f)),
+            glm::vec3(hit_world_matrix * glm::vec4(hit.triangle.v2, 1.0f))
+        );
+        result.distance = hit.distance;
+        return result;
+    }
+
+    // Builds the triangle BVH of every geometry in the spatial index that has none yet,
+    // several at a time on the job system, instead of on the first raycast reaching each.
+    void build_triangle_bvhs() const {
+        std::vector<const Geometry*> geometries{};
+        for (const auto& game_object : m_game_objects) {
+            auto renderer = game_object->get_component<Mesh_renderer_component>();
+            if (!renderer || renderer->spatial_proxy() == m_spatial_index.null_index) {
+                continue;
+            }
+            const auto* geometry = renderer->mesh_renderer()->geometry().get();
+            if (geometry && !geometry->has_triangle_bvh()) {
+                geometries.push_back(geometry);
+            }
+        }
+        std::sort(geometries.begin(), geometries.end());
+        geometries.erase(std::unique(geometries.begin(), geometries.end()), geometries.end());
+
+        Job_sys::get_instance()->parallel_for(geometries.size(), 1, [&](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; i++) {
+                geometries[i]->triangle_bvh();
+            }
+        });
+    }
+
+    // Takes everything this scene published in incremental mode back from the render
+    // side, e.g. when another scene becomes current. The ids to remove are appended.
+    void withdraw_render_objects(std::vector<uint32_t>& removed_object_ids) {
         for (auto& game_object : m_game_objects) {
+            unpublish_renderer(*game_object);
+        }
+        for (const auto& published : m_published_render_objects) {
+            removed_object_ids.push_back(published.object_id);
+        }
+        m_published_render_objects.clear();
+        m_published_index_of.clear();
+        m_pending_render_removals.clear();
+    }
+
+protected:
+    void build_object_lists() {
+        m_dynamic_objects.clear();
+        m_static_objects.clear();
+        for (auto& game_object : m_game_objects) {
+            if (game_object->is_static()) {
+                // static objects reach the render side through the static render list
+                unpublish_renderer(*game_object);
+                m_static_objects.push_back(game_object.get());
+            } else {
+                m_dynamic_objects.push_back(game_object.get());
+            }
+        }
+
+        m_object_list_static_version = m_static_version.load(std::memory_order_relaxed);
+        m_is_object_list_dirty = false;
+        m_is_static_render_list_dirty = true;
+        m_is_tick_partition_dirty = true;
+    }
+
+    // Ticks the static objects once into a scratch buffer and keeps what they emitted.
+    // The list is immutable once published, swap buffers still holding the previous
+    // one keep it alive until they are cleared.
+    void build_static_render_list(const Logic_tick_context& tick_context) {
+        m_is_static_render_list_dirty = false;
+        if (m_static_objects.empty()) {
+            m_static_render_list.reset();
+            return;
+        }
+
+        Swap_data static_data{};
+        Logic_tick_context static_context{tick_context.input_state, static_data, tick_context.delta_time};
+        for (auto* game_object : m_static_objects) {
+            game_object->tick(static_context);
+        }
+        resolve_model_matrices(static_data, 0);
+
+        auto list = std::make_shared<Static_render_list>();
+        list->render_objects.assign(static_data.render_objects.begin(), static_data.render_objects.end());
+        const auto& shadow_caster_indices = static_data.update_shadow_caster_indices();
+        list->shadow_caster_indices.assign(shadow_caster_indices.begin(), shadow_caster_indices.end());
+        list->directional_lights.assign(static_data.directional_lights.begin(), static_data.directional_lights.end());
+        list->point_lights.assign(static_data.point_lights.begin(), static_data.point_lights.end());
+        list->spot_lights.assign(static_data.spot_lights.begin(), static_data.spot_lights.end());
+        m_static_render_list = std::move(list);
+    }
+
+    // Mesh renderers only emit transform slots; once every object has ticked the
+    // world matrices are brought up to date in one pass, parents before children,
+    // and copied into the render records.
+    void resolve_model_matrices(Swap_data& data, std::size_t first_render_object) {
+        if (m_transform_update_order_registry_version != m_component_registry.version() ||
+            m_transform_update_order_hierarchy_version != Node::hierarchy_version()) {
+            build_transform_update_order();
+        }
+        m_transform_storage->update_world_matrices(m_transform_update_order);
+
+        auto& render_objects = data.render_objects;
+        auto count = render_objects.size() - first_render_object;
+        const auto& storage = *m_transform_storage;
+
+        auto resolve = [&](std::size_t begin, std::size_t end) {
+            for (auto i = first_render_object + begin; i < first_render_object + end; i++) {
+                render_objects[i].model_matrix = storage.cached_world_matrix(render_objects[i].transform_index);
+            }
+        };
+
+        if (m_tick_mode == Scene_tick_mode::PARALLEL) {
+            auto& job_system = *Job_sys::get_instance();
+            job_system.parallel_for(count, job_system.suggest_grain_size(count), resolve);
+        } else {
+            resolve(0, count);
+        }
+    }
+
+    void build_transform_update_order() {
+        m_transform_update_order.clear();
+        for (auto* component : m_component_registry.storage<Node_component>()) {
+            const auto& node = static_cast<Node_component*>(component)->node();
+            if (node && node->transform_storage() == m_transform_storage) {
+                m_transform_update_order.push_back(node->transform_index());
+            }
+        }
+        m_transform_storage->sort_update_order(m_transform_update_order);
+
+        m_transform_update_order_registry_version = m_component_registry.version();
+        m_transform_update_order_hierarchy_version = Node::hierarchy_version();
+    }
+
+    void update_batched_component_types() {
+        for (auto type_index : m_batched_component_types) {
+            m_component_registry.set_tick_batched(type_index, false);
+        }
+        m_batched_component_types = m_system_scheduler.batched_component_types();
+        for (auto type_index : m_batched_component_types) {
+            m_component_registry.set_tick_batched(type_index, true);
+        }
+        m_batched_graph_version = m_system_scheduler.graph_version();
+    }
+
+    void tick_components(const Logic_tick_context& tick_context) {
+        if (m_tick_mode == Scene_tick_mode::PARALLEL) {
+            parallel_tick(tick_context);
+        } else {
+            for (auto* game_object : m_dynamic_objects) {
+                game_object->tick(tick_context);
+            }
+        }
+    }
+
+    void append_spatial_object(uint32_t proxy, std::vector<std::shared_ptr<Game_object>>& game_objects) const {
+        if (auto game_object = get_game_object(m_spatial_index.payload(proxy).handle)) {
+            game_objects.push_back(std::move(game_object));
+        }
+    }
+
+    void unindex_renderer(Mesh_renderer_component& renderer) {
+        if (renderer.spatial_proxy() != m_spatial_index.null_index) {
+            m_spatial_index.remove(renderer.spatial_proxy());
+            renderer.set_spatial_proxy(m_spatial_index.null_index);
+        }
+    }
+
+    // Refits the leaves of renderers whose world matrix or geometry changed since they
+    // were last indexed and indexes the renderers that have none yet. A large batch
+    // of new leaves is followed by a full build rather than left to the insertions.
+    void update_spatial_index() {
+        const auto& storage = *m_transform_storage;
+        std::size_t inserted_count = 0;
+
+        for (auto* component : m_component_registry.storage<Mesh_renderer_component>()) {
+            auto& renderer = *static_cast<Mesh_renderer_component*>(component);
+            auto proxy = renderer.spatial_proxy();
+            const auto* geometry = renderer.mesh_renderer()->geometry().get();
+            auto transform_index = renderer.mesh_renderer()->node()->transform_index();
+            auto world_version = storage.world_version(transform_index);
+            bool has_bounds = geometry && !geometry->bounding_box().is_empty();
+
+            if (proxy == m_spatial_index.null_index) {
+                if (has_bounds) {
+                    renderer.set_spatial_proxy(m_spatial_index.insert(
+                        geometry->bounding_box() * storage.cached_world_matrix(transform_index),
+                        Scene_spatial_object{renderer.component_list()->scene_handle(), &renderer, geometry, world_version}
+                    ));
+                    inserted_count++;
+                }
+                continue;
+            }
+
+            auto& object = m_spatial_index.payload(proxy);
+            if (object.geometry == geometry && object.world_version == world_version) {
+                continue;
+            }
+
+            if (!has_bounds) {
+                m_spatial_index.remove(proxy);
+                renderer.set_spatial_proxy(m_spatial_index.null_index);
+                continue;
+            }
+            object.geometry = geometry;
+            object.world_version = world_version;
+            m_spatial_index.update(proxy, geometry->bounding_box() * storage.cached_world_matrix(transform_index));
+        }
+
+        if (inserted_count > m_spatial_index.size() / 2) {
+            m_spatial_index.rebuild();
+        }
+
+        if (++m_spatial_index_ticks % spatial_rebalance_interval == 0) {
+            m_spatial_index.rebalance();
+        }
+    }
+
+    void unpublish_renderer(Mesh_renderer_component& renderer) {
+        if (renderer.unpublish()) {
+            m_pending_render_removals.push_back(renderer.object_id());
+        }
+    }
+
+    void unpublish_renderer(Game_object& game_object) {
+        if (auto renderer = game_object.get_component<Mesh_renderer_component>()) {
+            unpublish_renderer(*renderer);
+        }
+    }
+
+    // Journals the removal of every published renderer that left the scene or did not
+    // tick this frame, being disabled or batched away, so the render side draws what
+    // full mode would. Then fills the model matrices of this frame's journal entries,
+    // keeps the published set in step with it and journals every published object whose
+    // world matrix was recomputed since it was last sent.
+    void journal_render_changes(Swap_data& data, std::size_t first_render_change) {
+        const auto& storage = *m_transform_storage;
+        auto& changes = data.render_changes;
+
+        for (auto* component : m_component_registry.storage<Mesh_renderer_component>()) {
+            auto& renderer = *static_cast<Mesh_renderer_component*>(component);
+            if (!renderer.consume_ticked()) {
+                unpublish_renderer(renderer);
+            }
+        }
+        for (auto object_id : m_pending_render_removals) {
+            changes.push_back(Swap_render_change{
+                Swap_render_change_type::REMOVED,
+                Swap_renderable_object{.object_id = object_id}
+            });
+        }
+        m_pending_render_removals.clear();
+        auto journaled_count = changes.size();
+
+        for (auto i = first_render_change; i < journaled_count; i++) {
+            auto& change = changes[i];
+            auto object_id = change.object.object_id;
+
+            if (change.type == Swap_render_change_type::REMOVED) {
+                auto it = m_published_index_of.find(object_id);
+                if (it == m_published_index_of.end()) {
+                    continue;
+                }
+                auto index = it->second;
+                m_published_index_of.erase(it);
+                if (index != m_published_render_objects.size() - 1) {
+                    m_published_render_objects[index] = m_published_render_objects.back();
+                    m_published_index_of[m_published_render_objects[index].object_id] = index;
+                }
+                m_published_render_objects.pop_back();
+                continue;
+            }
+
+            auto transform_index = change.object.transform_index;
+            change.object.model_matrix = storage.cached_world_matrix(transform_index);
+            Published_render_object published{object_id, transform_index, storage.world_version(transform_index)};
+
+            auto [it, is_inserted] = m_published_index_of.try_emplace(object_id, static_cast<uint32_t>(m_published_render_objects.size()));
+            if (is_inserted) {
+                m_published_render_objects.push_back(published);
+            } else {
+                m_published_render_objects[it->second] = published;
+            }
+        }
+
+        for (auto& published : m_published_render_objects) {
+            auto world_version = storage.world_version(published.transform_index);
+            if (world_version == published.world_version) {
+                continue;
+            }
+            published.world_version = world_version;
+            changes.push_back(Swap_render_change{
+                Swap_render_change_type::TRANSFORMED,
+                Swap_renderable_object{
+                    .object_id = published.object_id,
+                    .transform_index = published.transform_index,
+                    .model_matrix = storage.cached_world_matrix(published.transform_index)
+                }
+            });
+        }
+    }
+
+    // Every chunk ticks into its own Swap_data shard; the shards are appended to the
+    // logic swap data in chunk order once all workers are done, so no locking is needed.
+    void parallel_tick(const Logic_tick_context& tick_context) {
+        if (m_is_tick_partition_dirty || m_tick_partition_hierarchy_version != Node::hierarchy_version()) {
+            build_tick_partitions();
+        }
+
+        auto chunk_count = m_parallel_tick_chunk_offsets.size() - 1;
+        if (m_swap_data_shards.size() < chunk_count) {
+            m_swap_data_shards.resize(chunk_count);
+        }
+
+        Job_sys::get_instance()->parallel_for(chunk_count, 1, [&](std::size_t begin, std::size_t end) {
+            for (auto chunk = begin; chunk < end; chunk++) {
+                auto& shard = m_swap_data_shards[chunk];
+                shard.clear();
+                shard.is_incremental = tick_context.logic_swap_data.is_incremental;
+
+                Logic_tick_context shard_context{
+                    tick_context.input_state,
+                    shard,
+                    tick_context.delta_time
+                };
+
+                for (auto i = m_parallel_tick_chunk_offsets[chunk]; i < m_parallel_tick_chunk_offsets[chunk + 1]; i++) {
+                    m_parallel_tick_objects[i]->tick(shard_context);
+                }
+            }
+        });
+
+        auto& data = tick_context.logic_swap_data;
+        std::size_t render_object_count = data.render_objects.size();
+        for (std::size_t chunk = 0; chunk < chunk_count; chunk++) {
+            render_object_count += m_swap_data_shards[chunk].render_objects.size();
+        }
+        data.render_objects.reserve(render_object_count);
+
+        for (std::size_t chunk = 0; chunk < chunk_count; chunk++) {
+            data.append(m_swap_data_shards[chunk]);
+        }
+
+        // objects that reach into other hierarchies run after the workers have joined
+        for (auto* game_object : m_serial_tick_objects) {
             game_object->tick(tick_context);
         }
     }
 
+    void build_tick_partitions() {
+        m_parallel_tick_objects.clear();
+        m_parallel_tick_chunk_offsets.clear();
+        m_serial_tick_objects.clear();
+
+        std::unordered_map<const void*, std::size_t> group_of_root{};
+        std::vector<std::vector<Game_object*>> groups{};
+
+        for (auto* game_object : m_dynamic_objects) {
+            if (!game_object->is_parallel_tick_safe()) {
+                m_serial_tick_objects.push_back(game_object);
+                continue;
+            }
+
+            const void* root = game_object;
+            if (auto node_component = game_object->get_component<Node_component>()) {
+                root = node_component->node()->root_node();
+            }
+
+            auto [it, is_inserted] = group_of_root.try_emplace(root, groups.size());
+            if (is_inserted) {
+                groups.emplace_back();
+            }
+            groups[it->second].push_back(game_object);
+        }
+
+        std::size_t object_count = m_dynamic_objects.size() - m_serial_tick_objects.size();
+        std::size_t chunk_target = std::max<std::size_t>(1, object_count / (Job_sys::get_instance()->concurrency() * 4));
+
+        m_parallel_tick_chunk_offsets.push_back(0);
+        for (auto& group : groups) {
+            m_parallel_tick_objects.insert(m_parallel_tick_objects.end(), group.begin(), group.end());
+            if (m_parallel_tick_objects.size() - m_parallel_tick_chunk_offsets.back() >= chunk_target) {
+                m_parallel_tick_chunk_offsets.push_back(m_parallel_tick_objects.size());
+            }
+        }
+        if (m_parallel_tick_chunk_offsets.back() != m_parallel_tick_objects.size()) {
+            m_parallel_tick_chunk_offsets.push_back(m_parallel_tick_objects.size());
+        }
+
+        m_tick_partition_hierarchy_version = Node::hierarchy_version();
+        m_is_tick_partition_dirty = false;
+    }
+
 };
 
 };
\ No newline at end of file
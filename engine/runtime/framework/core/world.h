@@ -1,8 +1,12 @@
 #pragma once
 
+#include "engine/runtime/framework/component/node/transform_storage.h"
 #include "engine/runtime/framework/core/scene.h"
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace rtr {
@@ -10,24 +14,48 @@ namespace rtr {
 class World {
 protected:
     std::string m_name{};
+    // the storage of every node in the world's scenes; worlds ticked at the same time
+    // must not share one
+    std::shared_ptr<Transform_storage> m_transform_storage{};
     std::vector<std::shared_ptr<Scene>> m_scenes{};
     unsigned int m_current_scene_index{};
 
+    // incremental mode: the scene whose objects the render side currently holds, and
+    // removals to journal on the next tick after it was switched away from or removed
+    std::weak_ptr<Scene> m_ticked_scene{};
+    std::vector<uint32_t> m_pending_render_removals{};
+
 public:
-    World(const std::string& name) : m_name(name) {}
+    World(const std::string& name, std::shared_ptr<Transform_storage> transform_storage = Transform_storage::current()) :
+        m_name(name),
+        m_transform_storage(std::move(transform_storage)) {}
+
     static std::shared_ptr<World> create(const std::string& name) {
         return std::make_shared<World>(name);
     }
 
+    // A world with a Transform_storage of its own, so it can tick at the same time as
+    // other worlds. Build its scenes and game objects inside a Transform_storage::Scope of
+    // transform_storage(); its scenes reject game objects with nodes of another storage.
+    static std::shared_ptr<World> create_isolated(const std::string& name) {
+        return std::make_shared<World>(name, Transform_storage::create());
+    }
+
     virtual ~World() = default;
     const std::string& name() const { return m_name; }
 
+    const std::shared_ptr<Transform_storage>& transform_storage() const { return m_transform_storage; }
+
     std::shared_ptr<Scene> add_scene(const std::shared_ptr<Scene>& scene) {
+        if (scene->transform_storage() != m_transform_storage) {
+            throw std::invalid_argument("World: scene " + scene->name() + " was created for another transform storage");
+        }
         m_scenes.push_back(scene);
         return scene;
     }
 
     std::shared_ptr<Scene> add_scene(const std::string& name) {
+        Transform_storage::Scope scope{m_transform_storage};
         auto scene = Scene::create(name);
         m_scenes.push_back(scene);
         return scene;
@@ -47,6 +75,10 @@ public:
     void remove_scene(const std::string& name) {
         for (auto it = m_scenes.begin(); it != m_scenes.end(); ++it) {
             if ((*it)->name() == name) {
+                if (m_ticked_scene.lock() == *it) {
+                    (*it)->withdraw_render_objects(m_pending_render_removals);
+                    m_ticked_scene.reset();
+                }
                 m_scenes.erase(it);
                 return;
             }
@@ -89,7 +121,27 @@ public:
     }
 
     void tick(const Logic_tick_context& tick_context) {
-        current_scene()->tick(tick_context);
+        // nodes created while ticking belong to this world
+        Transform_storage::Scope scope{m_transform_storage};
+        auto scene = current_scene();
+        auto& data = tick_context.logic_swap_data;
+
+        if (auto ticked_scene = m_ticked_scene.lock(); ticked_scene && ticked_scene != scene) {
+            ticked_scene->withdraw_render_objects(m_pending_render_removals);
+        }
+        m_ticked_scene = scene;
+
+        if (data.is_incremental) {
+            for (auto object_id : m_pending_render_removals) {
+                data.render_changes.push_back(Swap_render_change{
+                    Swap_render_change_type::REMOVED,
+                    Swap_renderable_object{.object_id = object_id}
+                });
+            }
+        }
+        m_pending_render_removals.clear();
+
+        scene->tick(tick_context);
     }
     
 };
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "engine/runtime/framework/component/custom/ping_pong_component.h"
+#include "engine/runtime/framework/core/scene.h"
+#include "engine/runtime/framework/system/system.h"
+#include "engine/runtime/tool/job_system.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rtr {
+
+// Batched Ping_pong_component: advances the phases and places the nodes of every ping
+// pong component of the scene in flat loops over contiguous parameter arrays. Only the
+// phase is written back to the components. Of several components on one node, every
+// one advances its phase but only the one the game object ticks last places the node.
+class Ping_pong_system : public Base_system {
+protected:
+    static constexpr uint32_t no_entry = std::numeric_limits<uint32_t>::max();
+
+    std::vector<Ping_pong_component*> m_components{};
+    std::vector<uint32_t> m_transform_indices{};
+    std::vector<uint8_t> m_is_placing{};
+    // first entry of each transform slot gathered this tick, no_entry otherwise
+    std::vector<uint32_t> m_entry_of_slot{};
+    // entries whose node is shared with another entry
+    std::vector<uint32_t> m_shared_entries{};
+    std::vector<glm::vec3> m_positions{};
+    std::vector<float> m_speeds{};
+    std::vector<float> m_amplitudes{};
+    std::vector<double> m_times{};
+
+public:
+    inline static const std::string default_name{"ping_pong"};
+
+    Ping_pong_system() : Base_system(
+        default_name,
+        System_access{}.batch<Ping_pong_component>().write<Transform_storage>()
+    ) {}
+
+    static std::shared_ptr<Ping_pong_system> create() {
+        return std::make_shared<Ping_pong_system>();
+    }
+
+    void tick(const System_tick_context& tick_context) override {
+        auto delta_time = tick_context.logic_tick_context.delta_time;
+        const auto& components = tick_context.scene.component_registry().storage<Ping_pong_component>();
+
+        m_components.clear();
+        m_transform_indices.clear();
+        m_is_placing.clear();
+        m_shared_entries.clear();
+        m_positions.clear();
+        m_speeds.clear();
+        m_amplitudes.clear();
+        m_times.clear();
+        auto& storage = *tick_context.scene.transform_storage();
+        for (auto* base_component : components) {
+            auto& component = *static_cast<Ping_pong_component*>(base_component);
+            // a node of another storage is not this scene's to move, see
+            // Scene::build_transform_update_order
+            if (!component.is_enabled() || !component.node() || component.node()->transform_storage().get() != &storage) {
+                continue;
+            }
+            auto transform_index = component.node()->transform_index();
+            if (transform_index >= m_entry_of_slot.size()) {
+                m_entry_of_slot.resize(transform_index + 1, no_entry);
+            }
+            auto& first_entry = m_entry_of_slot[transform_index];
+            auto entry = static_cast<uint32_t>(m_components.size());
+            if (first_entry == no_entry) {
+                first_entry = entry;
+            } else {
+                m_shared_entries.push_back(first_entry);
+                m_shared_entries.push_back(entry);
+            }
+
+            m_components.push_back(&component);
+            m_transform_indices.push_back(transform_index);
+            m_is_placing.push_back(1);
+            m_positions.push_back(component.position());
+            m_speeds.push_back(component.speed());
+            m_amplitudes.push_back(component.amplitude());
+            m_times.push_back(component.time());
+        }
+
+        for (auto entry : m_shared_entries) {
+            m_is_placing[entry] = m_components[entry] == last_ticked(*m_components[entry]);
+        }
+        for (auto transform_index : m_transform_indices) {
+            m_entry_of_slot[transform_index] = no_entry;
+        }
+
+        auto count = m_components.size();
+        auto& job_system = *Job_sys::get_instance();
+        job_system.parallel_for(count, std::max<std::size_t>(4096, job_system.suggest_grain_size(count)), [&](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; i++) {
+                m_times[i] += m_speeds[i] * delta_time;
+            }
+            for (auto i = begin; i < end; i++) {
+                m_positions[i].y += static_cast<float>(m_amplitudes[i] * std::sin(m_times[i]));
+            }
+            for (auto i = begin; i < end; i++) {
+                if (m_is_placing[i]) {
+                    storage.set_position(m_transform_indices[i], m_positions[i]);
+                }
+                m_components[i]->time() = m_times[i];
+            }
+        });
+    }
+
+private:
+    // the enabled ping pong component next to component that the game object ticks last
+    static const Base_component* last_ticked(const Ping_pong_component& component) {
+        const Base_component* last{};
+        for (const auto& other : component.component_list()->components()) {
+            if (other->component_type_id() == component.component_type_id() && other->is_enabled()) {
+                last = other.get();
+            }
+        }
+        return last;
+    }
+};
+
+}
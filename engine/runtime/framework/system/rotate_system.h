@@ -0,0 +1,115 @@
+#pragma once
+
+#include "engine/runtime/framework/component/custom/rotate_component.h"
+#include "engine/runtime/framework/core/scene.h"
+#include "engine/runtime/framework/system/system.h"
+#include "engine/runtime/tool/job_system.h"
+#include "engine/runtime/tool/math.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rtr {
+
+// Batched Rotate_component. The parameters of every rotate component in the scene are
+// gathered into contiguous arrays, then all nodes are rotated with one SIMD quaternion
+// product pass instead of a virtual tick and a Node::rotate per component. Results are
+// the same as ticking the components one by one: several components on one node are
+// folded into a single delta, composed in the order the game object ticks them.
+class Rotate_system : public Base_system {
+protected:
+    static constexpr uint32_t no_entry = std::numeric_limits<uint32_t>::max();
+
+    std::vector<uint32_t> m_transform_indices{};
+    std::vector<glm::quat> m_deltas{};
+    std::vector<glm::quat> m_rotations{};
+    // entry of each transform slot gathered this tick, no_entry otherwise
+    std::vector<uint32_t> m_entry_of_slot{};
+    // entries rotated by more than one component, with one of those components
+    std::vector<std::pair<uint32_t, const Rotate_component*>> m_shared_entries{};
+
+public:
+    inline static const std::string default_name{"rotate"};
+
+    Rotate_system() : Base_system(
+        default_name,
+        System_access{}.batch<Rotate_component>().write<Transform_storage>()
+    ) {}
+
+    static std::shared_ptr<Rotate_system> create() {
+        return std::make_shared<Rotate_system>();
+    }
+
+    void tick(const System_tick_context& tick_context) override {
+        auto delta_time = tick_context.logic_tick_context.delta_time;
+        const auto& components = tick_context.scene.component_registry().storage<Rotate_component>();
+
+        m_transform_indices.clear();
+        m_deltas.clear();
+        m_shared_entries.clear();
+        auto& storage = *tick_context.scene.transform_storage();
+        for (auto* base_component : components) {
+            const auto& component = *static_cast<const Rotate_component*>(base_component);
+            // a node of another storage is not this scene's to move, see
+            // Scene::build_transform_update_order
+            if (!component.is_enabled() || !component.node() || component.node()->transform_storage().get() != &storage) {
+                continue;
+            }
+            auto transform_index = component.node()->transform_index();
+            if (transform_index >= m_entry_of_slot.size()) {
+                m_entry_of_slot.resize(transform_index + 1, no_entry);
+            }
+            auto& entry = m_entry_of_slot[transform_index];
+            if (entry != no_entry) {
+                m_shared_entries.emplace_back(entry, &component);
+                continue;
+            }
+            entry = static_cast<uint32_t>(m_transform_indices.size());
+            m_transform_indices.push_back(transform_index);
+            m_deltas.push_back(glm::angleAxis(glm::radians(component.speed() * delta_time), component.axis()));
+        }
+
+        for (auto [entry, component] : m_shared_entries) {
+            m_deltas[entry] = combined_delta(*component, delta_time);
+        }
+        for (auto transform_index : m_transform_indices) {
+            m_entry_of_slot[transform_index] = no_entry;
+        }
+
+        auto count = m_transform_indices.size();
+        m_rotations.resize(count);
+
+        // every chunk touches its own transform slots only
+        auto& job_system = *Job_sys::get_instance();
+        job_system.parallel_for(count, std::max<std::size_t>(4096, job_system.suggest_grain_size(count)), [&](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; i++) {
+                m_rotations[i] = storage.rotation(m_transform_indices[i]);
+            }
+            simd::multiply(m_deltas.data() + begin, m_rotations.data() + begin, m_rotations.data() + begin, end - begin);
+            for (auto i = begin; i < end; i++) {
+                storage.set_rotation(m_transform_indices[i], m_rotations[i]);
+            }
+        });
+    }
+
+private:
+    // the deltas of all enabled rotate components next to component, later ones applied last
+    static glm::quat combined_delta(const Rotate_component& component, float delta_time) {
+        auto delta = glm::identity<glm::quat>();
+        for (const auto& other : component.component_list()->components()) {
+            if (other->component_type_id() != component.component_type_id() || !other->is_enabled()) {
+                continue;
+            }
+            const auto& rotate = static_cast<const Rotate_component&>(*other);
+            delta = glm::angleAxis(glm::radians(rotate.speed() * delta_time), rotate.axis()) * delta;
+        }
+        return delta;
+    }
+};
+
+}
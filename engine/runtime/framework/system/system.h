@@ -0,0 +1,153 @@
+#pragma once
+
+#include "engine/runtime/context/tick_context/logic_tick_context.h"
+#include "engine/runtime/framework/component/component.h"
+#include "engine/runtime/tool/pool_allocator.h"
+#include "engine/runtime/tool/type_id.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace rtr {
+
+class Scene;
+
+// The data a system touches, declared by type: component types for the components it
+// visits, or any other type standing for a shared resource (Swap_data for the logic
+// swap buffer, Transform_storage for node transforms). Two systems conflict when one
+// writes a type the other reads or writes; conflicting systems run in the order they
+// were added, all others may run at the same time. Declarations are not checked.
+class System_access {
+public:
+    struct Entry {
+        uint64_t id{};
+        std::string name{};
+    };
+
+private:
+    std::vector<Entry> m_reads{};
+    std::vector<Entry> m_writes{};
+    std::vector<uint32_t> m_batched_component_types{};
+    bool m_is_exclusive{false};
+
+public:
+    template<typename T>
+    System_access& read() {
+        add(m_reads, type_id<T>(), readable_type_name(typeid(T)));
+        return *this;
+    }
+
+    template<typename T>
+    System_access& write() {
+        add(m_writes, type_id<T>(), readable_type_name(typeid(T)));
+        return *this;
+    }
+
+    // The system ticks every component whose dynamic type is exactly T itself, their
+    // Base_component::tick is skipped while the system is enabled. Implies write<T>().
+    template<typename T>
+    System_access& batch() {
+        write<T>();
+        auto type_index = Component_type_index::of<T>();
+        if (std::find(m_batched_component_types.begin(), m_batched_component_types.end(), type_index) == m_batched_component_types.end()) {
+            m_batched_component_types.push_back(type_index);
+        }
+        return *this;
+    }
+
+    // reads and writes everything, so it conflicts with every other system
+    System_access& exclusive() {
+        m_is_exclusive = true;
+        return *this;
+    }
+
+    const std::vector<Entry>& reads() const { return m_reads; }
+    const std::vector<Entry>& writes() const { return m_writes; }
+    const std::vector<uint32_t>& batched_component_types() const { return m_batched_component_types; }
+    bool is_exclusive() const { return m_is_exclusive; }
+
+    bool conflicts_with(const System_access& other) const {
+        if (m_is_exclusive || other.m_is_exclusive) {
+            return true;
+        }
+        return intersects(m_writes, other.m_writes) ||
+            intersects(m_writes, other.m_reads) ||
+            intersects(m_reads, other.m_writes);
+    }
+
+private:
+    static void add(std::vector<Entry>& entries, uint64_t id, std::string name) {
+        if (std::none_of(entries.begin(), entries.end(), [&](const Entry& entry) { return entry.id == id; })) {
+            entries.push_back(Entry{id, std::move(name)});
+        }
+    }
+
+    static bool intersects(const std::vector<Entry>& lhs, const std::vector<Entry>& rhs) {
+        for (const auto& entry : lhs) {
+            for (const auto& other : rhs) {
+                if (entry.id == other.id) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+struct System_tick_context {
+    Scene& scene;
+    const Logic_tick_context& logic_tick_context;
+};
+
+// Logic that runs once per scene tick over all components of the types it declares,
+// instead of once per component through Base_component::tick.
+class Base_system {
+protected:
+    std::string m_name{};
+    System_access m_access{};
+    bool m_is_enabled{true};
+
+public:
+    Base_system(std::string name, System_access access) :
+        m_name(std::move(name)),
+        m_access(std::move(access)) {}
+
+    virtual ~Base_system() = default;
+
+    virtual void tick(const System_tick_context& tick_context) = 0;
+
+    const std::string& name() const { return m_name; }
+    const System_access& access() const { return m_access; }
+
+    bool is_enabled() const { return m_is_enabled; }
+    void set_enabled(bool enabled) { m_is_enabled = enabled; }
+};
+
+class Function_system : public Base_system {
+public:
+    using Function = std::function<void(const System_tick_context&)>;
+
+protected:
+    Function m_function{};
+
+public:
+    Function_system(std::string name, System_access access, Function function) :
+        Base_system(std::move(name), std::move(access)),
+        m_function(std::move(function)) {}
+
+    static std::shared_ptr<Function_system> create(std::string name, System_access access, Function function) {
+        return std::make_shared<Function_system>(std::move(name), std::move(access), std::move(function));
+    }
+
+    void tick(const System_tick_context& tick_context) override {
+        m_function(tick_context);
+    }
+};
+
+}
@@ -0,0 +1,306 @@
+#pragma once
+
+#include "engine/runtime/framework/system/system.h"
+#include "engine/runtime/tool/job_system.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace rtr {
+
+struct System_timing {
+    // offset from the start of the schedule's run
+    double start_ms{};
+    double duration_ms{};
+    // exponential moving average of duration_ms
+    double average_ms{};
+    bool is_on_worker{false};
+};
+
+// Runs systems as a DAG on the Job_system. Every system depends on the earlier added
+// systems it conflicts with (see System_access), so the result is the same as running
+// them one after another in order. Exclusive systems run on the calling thread, so they
+// see its thread local state (e.g. a bound Transform_storage::Scope); all others may
+// run on workers. The graph is rebuilt on the first run after the set of systems or
+// one of their enabled flags changed.
+class System_scheduler {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Scheduled_system {
+        std::shared_ptr<Base_system> system{};
+        // indices of the enabled systems this one waits for, transitive edges removed
+        std::vector<std::size_t> dependencies{};
+        // longest dependency chain in front of the system; systems of a wave never conflict
+        std::size_t wave{};
+        bool is_enabled{true};
+        System_timing timing{};
+    };
+
+    std::vector<Scheduled_system> m_systems{};
+    bool m_is_graph_dirty{true};
+    uint64_t m_graph_version{};
+    // of the enabled systems, see System_access::batch
+    std::vector<uint32_t> m_batched_component_types{};
+    std::size_t m_enabled_count{};
+    std::size_t m_wave_count{};
+    double m_last_run_ms{};
+
+public:
+    System_scheduler() = default;
+    ~System_scheduler() = default;
+
+    void add_system(const std::shared_ptr<Base_system>& system) {
+        if (!system) {
+            return;
+        }
+        if (find(system->name())) {
+            throw std::invalid_argument("System_scheduler: a system named " + system->name() + " already exists");
+        }
+        m_systems.push_back(Scheduled_system{.system = system});
+        m_is_graph_dirty = true;
+    }
+
+    void remove_system(const std::string& name) {
+        auto it = std::find_if(m_systems.begin(), m_systems.end(), [&](const Scheduled_system& scheduled) {
+            return scheduled.system->name() == name;
+        });
+        if (it != m_systems.end()) {
+            m_systems.erase(it);
+            m_is_graph_dirty = true;
+        }
+    }
+
+    std::shared_ptr<Base_system> get_system(const std::string& name) const {
+        auto* scheduled = find(name);
+        return scheduled ? scheduled->system : nullptr;
+    }
+
+    std::size_t system_count() const { return m_systems.size(); }
+
+    const System_timing* timing(const std::string& name) const {
+        auto* scheduled = find(name);
+        return scheduled ? &scheduled->timing : nullptr;
+    }
+
+    double last_run_ms() const { return m_last_run_ms; }
+
+    // Rebuilds the graph if systems were added, removed, enabled or disabled since the
+    // last build; run() does this itself.
+    void prepare() {
+        for (auto& scheduled : m_systems) {
+            if (scheduled.is_enabled != scheduled.system->is_enabled()) {
+                m_is_graph_dirty = true;
+            }
+        }
+        if (m_is_graph_dirty) {
+            build_graph();
+        }
+    }
+
+    // bumped by every rebuild of the graph
+    uint64_t graph_version() const { return m_graph_version; }
+
+    const std::vector<uint32_t>& batched_component_types() const { return m_batched_component_types; }
+
+    void run(const System_tick_context& tick_context) {
+        prepare();
+
+        auto start = Clock::now();
+        auto& job_system = *Job_sys::get_instance();
+
+        if (job_system.worker_count() == 0 || m_wave_count == m_enabled_count) {
+            // nothing can overlap, skip the jobs
+            for (auto& scheduled : m_systems) {
+                if (scheduled.is_enabled) {
+                    run_system(scheduled, tick_context, start);
+                }
+            }
+        } else {
+            std::vector<Job_handle> jobs(m_systems.size());
+            std::exception_ptr exception{};
+            auto wait_jobs = [&]() {
+                // every job references this frame's context, so all of them must finish
+                for (auto& job : jobs) {
+                    try {
+                        job_system.wait(job);
+                    } catch (...) {
+                        if (!exception) {
+                            exception = std::current_exception();
+                        }
+                    }
+                    job.reset();
+                }
+            };
+
+            for (std::size_t i = 0; i < m_systems.size(); i++) {
+                auto& scheduled = m_systems[i];
+                if (!scheduled.is_enabled) {
+                    continue;
+                }
+
+                // everything before depends on it and it on everything before
+                if (scheduled.system->access().is_exclusive()) {
+                    wait_jobs();
+                    if (exception) {
+                        break;
+                    }
+                    run_system(scheduled, tick_context, start);
+                    continue;
+                }
+
+                std::vector<Job_handle> dependencies{};
+                dependencies.reserve(scheduled.dependencies.size());
+                for (auto dependency : scheduled.dependencies) {
+                    dependencies.push_back(jobs[dependency]);
+                }
+                jobs[i] = job_system.schedule([this, &scheduled, &tick_context, start]() {
+                    run_system(scheduled, tick_context, start);
+                }, dependencies);
+            }
+
+            wait_jobs();
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        m_last_run_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // The schedule of the last run grouped by wave, with each system's declared access,
+    // dependencies and timings.
+    std::string dump() const {
+        std::string result = std::format("{} systems in {} waves, last run {:.3f} ms\n",
+            m_systems.size(), m_wave_count, m_last_run_ms);
+
+        for (std::size_t wave = 0; wave < m_wave_count; wave++) {
+            result += std::format("wave {}\n", wave);
+            for (const auto& scheduled : m_systems) {
+                if (!scheduled.is_enabled || scheduled.wave != wave) {
+                    continue;
+                }
+
+                const auto& timing = scheduled.timing;
+                result += std::format("  {:<32} start {:8.3f} ms  took {:8.3f} ms  avg {:8.3f} ms  {}\n",
+                    scheduled.system->name(), timing.start_ms, timing.duration_ms, timing.average_ms,
+                    timing.is_on_worker ? "worker" : "caller");
+
+                const auto& access = scheduled.system->access();
+                if (access.is_exclusive()) {
+                    result += "    exclusive\n";
+                }
+                if (!access.reads().empty()) {
+                    result += "    reads  " + join_names(access.reads()) + "\n";
+                }
+                if (!access.writes().empty()) {
+                    result += "    writes " + join_names(access.writes()) + "\n";
+                }
+                if (!scheduled.dependencies.empty()) {
+                    std::string names{};
+                    for (auto dependency : scheduled.dependencies) {
+                        names += (names.empty() ? "" : ", ") + m_systems[dependency].system->name();
+                    }
+                    result += "    after  " + names + "\n";
+                }
+            }
+        }
+
+        for (const auto& scheduled : m_systems) {
+            if (!scheduled.is_enabled) {
+                result += std::format("disabled {}\n", scheduled.system->name());
+            }
+        }
+        return result;
+    }
+
+private:
+    const Scheduled_system* find(const std::string& name) const {
+        for (const auto& scheduled : m_systems) {
+            if (scheduled.system->name() == name) {
+                return &scheduled;
+            }
+        }
+        return nullptr;
+    }
+
+    void run_system(Scheduled_system& scheduled, const System_tick_context& tick_context, Clock::time_point run_start) {
+        auto start = Clock::now();
+        scheduled.system->tick(tick_context);
+        auto end = Clock::now();
+
+        auto& timing = scheduled.timing;
+        timing.start_ms = std::chrono::duration<double, std::milli>(start - run_start).count();
+        timing.duration_ms = std::chrono::duration<double, std::milli>(end - start).count();
+        timing.average_ms = timing.average_ms == 0.0 ? timing.duration_ms : timing.average_ms * 0.9 + timing.duration_ms * 0.1;
+        timing.is_on_worker = Job_sys::get_instance()->is_worker_thread();
+    }
+
+    void build_graph() {
+        auto count = m_systems.size();
+        std::vector<std::vector<bool>> is_reachable(count, std::vector<bool>(count, false));
+        m_enabled_count = 0;
+        m_wave_count = 0;
+        m_batched_component_types.clear();
+
+        for (std::size_t i = 0; i < count; i++) {
+            auto& scheduled = m_systems[i];
+            scheduled.is_enabled = scheduled.system->is_enabled();
+            scheduled.dependencies.clear();
+            scheduled.wave = 0;
+            if (!scheduled.is_enabled) {
+                continue;
+            }
+            m_enabled_count++;
+            for (auto type_index : scheduled.system->access().batched_component_types()) {
+                if (std::find(m_batched_component_types.begin(), m_batched_component_types.end(), type_index) == m_batched_component_types.end()) {
+                    m_batched_component_types.push_back(type_index);
+                }
+            }
+
+            // latest first, so an earlier conflict already ordered through a later one
+            // is recognised as transitive and left out
+            for (auto j = i; j-- > 0;) {
+                auto& earlier = m_systems[j];
+                if (!earlier.is_enabled || is_reachable[i][j]) {
+                    continue;
+                }
+                if (!scheduled.system->access().conflicts_with(earlier.system->access())) {
+                    continue;
+                }
+
+                scheduled.dependencies.push_back(j);
+                scheduled.wave = std::max(scheduled.wave, earlier.wave + 1);
+                is_reachable[i][j] = true;
+                for (std::size_t k = 0; k < j; k++) {
+                    if (is_reachable[j][k]) {
+                        is_reachable[i][k] = true;
+                    }
+                }
+            }
+            std::reverse(scheduled.dependencies.begin(), scheduled.dependencies.end());
+            m_wave_count = std::max(m_wave_count, scheduled.wave + 1);
+        }
+
+        m_graph_version++;
+        m_is_graph_dirty = false;
+    }
+
+    static std::string join_names(const std::vector<System_access::Entry>& entries) {
+        std::string result{};
+        for (const auto& entry : entries) {
+            result += (result.empty() ? "" : ", ") + entry.name;
+        }
+        return result;
+    }
+};
+
+}
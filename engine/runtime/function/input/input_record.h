@@ -0,0 +1,218 @@
+#pragma once
+
+#include "engine/runtime/function/input/input_system.h"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace rtr {
+
+// Binary input recording: a header followed by one record per frame.
+//
+// header: "RTRI" | u32 version | u32 frame count
+// frame:  f32 delta_time | 6 x f64 mouse x, y, dx, dy, scroll dx, dy
+//         | u8 n, n x (u8 mod, u8 action)
+//         | u16 n, n x (u16 key, u8 action)
+//         | u8 n, n x (u8 button, u8 action)
+//
+// Released keys and buttons are not stored, Input_state reports missing entries
+// as released anyway. All values are written in native byte order.
+namespace input_record {
+
+inline constexpr char magic[4] = {'R', 'T', 'R', 'I'};
+inline constexpr uint32_t version = 1;
+// offset of the frame count inside the header
+inline constexpr std::streamoff frame_count_offset = 8;
+
+}
+
+class Input_recorder {
+private:
+    std::ofstream m_file{};
+    uint32_t m_frame_count{0};
+
+public:
+    Input_recorder(const std::string& path) : m_file(path, std::ios::binary | std::ios::trunc) {
+        if (!m_file) {
+            throw std::runtime_error("Input_recorder: cannot open " + path);
+        }
+        m_file.write(input_record::magic, sizeof(input_record::magic));
+        write(input_record::version);
+        write(m_frame_count);
+    }
+
+    ~Input_recorder() = default;
+
+    Input_recorder(const Input_recorder&) = delete;
+    Input_recorder& operator=(const Input_recorder&) = delete;
+
+    static std::shared_ptr<Input_recorder> create(const std::string& path) {
+        return std::make_shared<Input_recorder>(path);
+    }
+
+    uint32_t frame_count() const { return m_frame_count; }
+
+    void record(const Input_state& state, float delta_time) {
+        write(delta_time);
+        write(state.mouse_x);
+        write(state.mouse_y);
+        write(state.mouse_dx);
+        write(state.mouse_dy);
+        write(state.mouse_scroll_dx);
+        write(state.mouse_scroll_dy);
+
+        write(static_cast<uint8_t>(count_pressed(state.key_mods)));
+        for (const auto& [mod, action] : state.key_mods) {
+            if (action != Key_action::RELEASE) {
+                write(static_cast<uint8_t>(mod));
+                write(static_cast<uint8_t>(action));
+            }
+        }
+
+        write(static_cast<uint16_t>(count_pressed(state.keys)));
+        for (const auto& [key, action] : state.keys) {
+            if (action != Key_action::RELEASE) {
+                write(static_cast<uint16_t>(key));
+                write(static_cast<uint8_t>(action));
+            }
+        }
+
+        write(static_cast<uint8_t>(count_pressed(state.mouse_buttons)));
+        for (const auto& [button, action] : state.mouse_buttons) {
+            if (action != Key_action::RELEASE) {
+                write(static_cast<uint8_t>(button));
+                write(static_cast<uint8_t>(action));
+            }
+        }
+
+        m_frame_count++;
+        commit_frame_count();
+    }
+
+private:
+    // Keeps the header in step with every recorded frame and flushes, so a run that
+    // crashes or is killed still leaves a recording of all frames up to then.
+    void commit_frame_count() {
+        auto end = m_file.tellp();
+        m_file.seekp(input_record::frame_count_offset);
+        write(m_frame_count);
+        m_file.seekp(end);
+        m_file.flush();
+    }
+
+    template<typename T>
+    void write(const T& value) {
+        m_file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename Map>
+    static std::size_t count_pressed(const Map& map) {
+        std::size_t count = 0;
+        for (const auto& [_, action] : map) {
+            if (action != Key_action::RELEASE) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+};
+
+class Input_replayer {
+private:
+    std::ifstream m_file{};
+    uint32_t m_frame_count{0};
+    uint32_t m_frame_index{0};
+
+public:
+    Input_replayer(const std::string& path) : m_file(path, std::ios::binary) {
+        if (!m_file) {
+            throw std::runtime_error("Input_replayer: cannot open " + path);
+        }
+
+        char magic[4]{};
+        m_file.read(magic, sizeof(magic));
+        uint32_t version{};
+        read(version);
+        read(m_frame_count);
+
+        if (!m_file || std::string(magic, 4) != std::string(input_record::magic, 4) || version != input_record::version) {
+            throw std::runtime_error("Input_replayer: " + path + " is not an input recording");
+        }
+    }
+
+    ~Input_replayer() = default;
+
+    Input_replayer(const Input_replayer&) = delete;
+    Input_replayer& operator=(const Input_replayer&) = delete;
+
+    static std::shared_ptr<Input_replayer> create(const std::string& path) {
+        return std::make_shared<Input_replayer>(path);
+    }
+
+    uint32_t frame_count() const { return m_frame_count; }
+    uint32_t frame_index() const { return m_frame_index; }
+    bool is_finished() const { return m_frame_index >= m_frame_count; }
+
+    // Overwrites state and delta_time with the next recorded frame, returns false once the recording is exhausted.
+    bool next(Input_state& state, float& delta_time) {
+        if (is_finished()) {
+            return false;
+        }
+
+        read(delta_time);
+        read(state.mouse_x);
+        read(state.mouse_y);
+        read(state.mouse_dx);
+        read(state.mouse_dy);
+        read(state.mouse_scroll_dx);
+        read(state.mouse_scroll_dy);
+
+        state.key_mods.clear();
+        auto mod_count = read<uint8_t>();
+        for (uint8_t i = 0; i < mod_count; i++) {
+            auto mod = static_cast<Key_mod>(read<uint8_t>());
+            state.key_mods[mod] = static_cast<Key_action>(read<uint8_t>());
+        }
+
+        state.keys.clear();
+        auto key_count = read<uint16_t>();
+        for (uint16_t i = 0; i < key_count; i++) {
+            auto key = static_cast<Key_code>(read<uint16_t>());
+            state.keys[key] = static_cast<Key_action>(read<uint8_t>());
+        }
+
+        state.mouse_buttons.clear();
+        auto button_count = read<uint8_t>();
+        for (uint8_t i = 0; i < button_count; i++) {
+            auto button = static_cast<Mouse_button>(read<uint8_t>());
+            state.mouse_buttons[button] = static_cast<Key_action>(read<uint8_t>());
+        }
+
+        if (!m_file) {
+            throw std::runtime_error("Input_replayer: recording is truncated");
+        }
+
+        m_frame_index++;
+        return true;
+    }
+
+private:
+    template<typename T>
+    void read(T& value) {
+        m_file.read(reinterpret_cast<char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    T read() {
+        T value{};
+        read(value);
+        return value;
+    }
+
+};
+
+}
@@ -130,6 +130,7 @@ public:
     ~Vertex_attribute() = default;
 
     std::vector<T>& data() { return m_data; }
+    const std::vector<T>& data() const { return m_data; }
     unsigned int data_count() const override { return m_data.size(); }
     unsigned int data_size() const override { return m_data.size() * sizeof(T); }
     unsigned int unit_data_count() const override  { return UNIT_DATA_COUNT; }
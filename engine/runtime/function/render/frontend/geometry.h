@@ -4,9 +4,16 @@
 #include "engine/runtime/platform/rhi/rhi_buffer.h"
 #include "engine/runtime/platform/rhi/rhi_device.h"
 #include "engine/runtime/platform/rhi/rhi_linker.h"
+#include "engine/runtime/tool/math.h"
+#include "engine/runtime/tool/triangle_bvh.h"
 
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <unordered_map>
+#include <vector>
 
 namespace rtr {
 
@@ -15,12 +22,23 @@ protected:
     std::unordered_map<unsigned int, std::shared_ptr<Vertex_attribute_base>> m_vertex_attributes{};
     std::shared_ptr<Element_attribute> m_element_attribute{};
 
+    // object space bounds of the positions at location 0, empty without positions
+    Bouding_box m_bounding_box{};
+    Sphere m_bounding_sphere{};
+
+    // built by the first triangle_bvh() call, dropped by update_bounds()
+    mutable std::shared_ptr<const Triangle_bvh> m_triangle_bvh{};
+    mutable std::mutex m_triangle_bvh_mutex{};
+    uint64_t m_positions_version{};
+
 public:
     Geometry(
         const std::unordered_map<unsigned int, std::shared_ptr<Vertex_attribute_base>>& vertex_attributes,
         const std::shared_ptr<Element_attribute> & element_attribute
     ) : m_vertex_attributes(vertex_attributes), 
-        m_element_attribute(element_attribute) {}
+        m_element_attribute(element_attribute) {
+        update_bounds();
+    }
 
     ~Geometry() = default;
 
@@ -54,6 +72,64 @@ public:
         );
     }
 
+    const Bouding_box& bounding_box() const { return m_bounding_box; }
+    // infinite for geometry without positions, so culling never rejects it
+    const Sphere& bounding_sphere() const { return m_bounding_sphere; }
+
+    // Ray cast hierarchy over the triangles of the positions at location 0, built on
+    // the first call; empty for geometry without positions. The build runs on the job
+    // system without holding the lock, so threads that ask at the same time may each
+    // build one and the first to finish is kept.
+    std::shared_ptr<const Triangle_bvh> triangle_bvh() const {
+        uint64_t version{};
+        {
+            std::lock_guard<std::mutex> lock(m_triangle_bvh_mutex);
+            if (m_triangle_bvh) {
+                return m_triangle_bvh;
+            }
+            version = m_positions_version;
+        }
+
+        std::shared_ptr<const Triangle_bvh> triangle_bvh{};
+        auto positions = std::dynamic_pointer_cast<Position_attribute>(attribute(0));
+        if (!positions) {
+            triangle_bvh = Triangle_bvh::create({}, {});
+        } else if (m_element_attribute) {
+            triangle_bvh = Triangle_bvh::create(positions->data(), m_element_attribute->data());
+        } else {
+            std::vector<uint32_t> indices(positions->unit_count());
+            std::iota(indices.begin(), indices.end(), 0);
+            triangle_bvh = Triangle_bvh::create(positions->data(), indices);
+        }
+
+        std::lock_guard<std::mutex> lock(m_triangle_bvh_mutex);
+        if (!m_triangle_bvh && version == m_positions_version) {
+            m_triangle_bvh = triangle_bvh;
+        }
+        return m_triangle_bvh ? m_triangle_bvh : triangle_bvh;
+    }
+
+    bool has_triangle_bvh() const {
+        std::lock_guard<std::mutex> lock(m_triangle_bvh_mutex);
+        return m_triangle_bvh != nullptr;
+    }
+
+    // call after changing the positions through attributes(); drops the triangle_bvh() as well
+    void update_bounds() {
+        {
+            std::lock_guard<std::mutex> lock(m_triangle_bvh_mutex);
+            m_triangle_bvh.reset();
+            m_positions_version++;
+        }
+        auto positions = std::dynamic_pointer_cast<Position_attribute>(attribute(0));
+        m_bounding_box = positions ? compute_bounding_box(*positions) : Bouding_box{};
+        if (m_bounding_box.is_empty()) {
+            m_bounding_sphere = Sphere(glm::vec3(0.0f), std::numeric_limits<float>::infinity());
+        } else {
+            m_bounding_sphere = Sphere(m_bounding_box);
+        }
+    }
+
     static Bouding_box compute_bounding_box(const Position_attribute& position_attribute) {
         Bouding_box bounding_box{};
         for (unsigned int i = 0; i < position_attribute.unit_count(); i++) {
@@ -5,9 +5,13 @@
 #include "engine/runtime/function/render/frontend/frame_buffer.h"
 #include "engine/runtime/function/render/frontend/texture.h"
 #include "engine/runtime/function/render/pass/base_pass.h"
+#include "engine/runtime/function/render/utils/frustum_culler.h"
+#include "engine/runtime/function/render/utils/occlusion_culler.h"
 #include "engine/runtime/function/render/utils/skybox.h"
+#include "engine/runtime/tool/math.h"
 
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -18,7 +22,14 @@ public:
 
     struct Execution_context {
         std::shared_ptr<Skybox> skybox{};
-        std::vector<Swap_renderable_object> render_swap_objects{};
+        std::span<const Swap_renderable_object> render_swap_objects{};
+        std::span<const Swap_renderable_object> static_render_swap_objects{};
+        // the camera's, objects outside are not drawn
+        bool is_frustum_culling{false};
+        Frustum frustum{};
+        // objects hidden behind the largest ones are not drawn either
+        bool is_occlusion_culling{false};
+        glm::mat4 view_projection{1.0f};
     };
 
     struct Resource_flow {
@@ -36,6 +47,12 @@ protected:
     std::shared_ptr<Frame_buffer> m_frame_buffer{};
     Execution_context m_context{};
     Resource_flow m_resource_flow{};
+
+    Frustum_culler m_frustum_culler{};
+    Occlusion_culler m_occlusion_culler{};
+    Occlusion_stats m_occlusion_stats{};
+    std::vector<uint32_t> m_static_visible_indices{};
+    std::vector<uint32_t> m_visible_indices{};
     
 public:
     Main_pass(
@@ -47,10 +64,15 @@ public:
     void set_resource_flow(const Resource_flow& flow) {
         m_resource_flow = flow;
         
+        auto color_attachment = m_resource_flow.color_attachment_out;
+
+        // sized like the color attachment, which need not match the window when rendering offscreen
         int width = m_rhi_global_resource.window->width();
         int height = m_rhi_global_resource.window->height();
-
-        auto color_attachment = m_resource_flow.color_attachment_out;
+        if (auto color_texture = std::dynamic_pointer_cast<Texture_2D>(color_attachment)) {
+            width = color_texture->width();
+            height = color_texture->height();
+        }
 
         m_frame_buffer = Frame_buffer::create(
             width, height, 
@@ -66,7 +88,14 @@ public:
         m_context = context;
     }
 
+    // of the last excute(), empty without frustum culling
+    const Culling_stats& culling_stats() const { return m_frustum_culler.stats(); }
+    // of the last excute(), empty without occlusion culling
+    const Occlusion_stats& occlusion_stats() const { return m_occlusion_stats; }
+
     void excute() override {
+        m_frustum_culler.reset_stats();
+        m_occlusion_stats = Occlusion_stats{};
         
         m_rhi_global_resource.renderer->clear(m_frame_buffer->rhi(m_rhi_global_resource.device));
 
@@ -93,28 +122,82 @@ public:
         m_resource_flow.shadow_map_in->rhi(m_rhi_global_resource.device)->generate_mipmap();
         m_resource_flow.shadow_map_in->rhi(m_rhi_global_resource.device)->bind_to_unit(5);
         
-        for (auto& swap_object : m_context.render_swap_objects) {
-            auto shader = swap_object.material->get_shader_program();
-            auto geometry = swap_object.geometry;
-
-            auto texture_map = swap_object.material->get_texture_map();
-            for (auto &[location, tex] : texture_map) {
-                tex->rhi(m_rhi_global_resource.device)->bind_to_unit(location);
+        auto static_objects = m_context.static_render_swap_objects;
+        auto objects = m_context.render_swap_objects;
+        if (!m_context.is_frustum_culling && !m_context.is_occlusion_culling) {
+            for (auto& swap_object : static_objects) {
+                draw(swap_object);
+            }
+            for (auto& swap_object : objects) {
+                draw(swap_object);
             }
+            return;
+        }
 
-            m_rhi_global_resource.pipeline_state->state = swap_object.material->get_pipeline_state();
-            m_rhi_global_resource.pipeline_state->apply();
+        select_visible(static_objects, m_static_visible_indices);
+        select_visible(objects, m_visible_indices);
+
+        // occluders may come from either list and hide objects of both
+        if (m_context.is_occlusion_culling) {
+            m_occlusion_culler.begin(m_context.view_projection);
+            m_occlusion_culler.add_candidates(static_objects, m_static_visible_indices);
+            m_occlusion_culler.add_candidates(objects, m_visible_indices);
+            m_occlusion_culler.rasterize_occluders();
+            m_occlusion_culler.cull(static_objects, m_static_visible_indices);
+            m_occlusion_culler.cull(objects, m_visible_indices);
+            m_occlusion_stats = m_occlusion_culler.stats();
+        }
 
-            swap_object.material->modify_shader_uniform(shader->rhi(m_rhi_global_resource.device));
-            shader->rhi(m_rhi_global_resource.device)->modify_uniform("model", swap_object.model_matrix);
-            shader->rhi(m_rhi_global_resource.device)->update_uniforms();
+        for (auto index : m_static_visible_indices) {
+            draw(static_objects[index]);
+        }
+        for (auto index : m_visible_indices) {
+            draw(objects[index]);
+        }
+    }
 
-            m_rhi_global_resource.renderer->draw(
-                shader->rhi(m_rhi_global_resource.device),
-                geometry->rhi(m_rhi_global_resource.device),
-                m_frame_buffer->rhi(m_rhi_global_resource.device)
-            );
+private:
+    void select_visible(std::span<const Swap_renderable_object> swap_objects, std::vector<uint32_t>& visible_indices) {
+        if (m_context.is_frustum_culling) {
+            m_frustum_culler.cull(m_context.frustum, swap_objects, visible_indices);
+            return;
         }
+
+        visible_indices.resize(swap_objects.size());
+        for (std::size_t i = 0; i < swap_objects.size(); i++) {
+            visible_indices[i] = static_cast<uint32_t>(i);
+        }
+    }
+
+    void draw(const Swap_renderable_object& swap_object) {
+        auto& material_table = *Material_table::get_instance();
+        auto& geometry_table = *Geometry_table::get_instance();
+
+        auto material = material_table.get(swap_object.material);
+        auto geometry = geometry_table.get(swap_object.geometry);
+        if (!material || !geometry) {
+            return;
+        }
+
+        auto shader = material->get_shader_program();
+
+        auto texture_map = material->get_texture_map();
+        for (auto &[location, tex] : texture_map) {
+            tex->rhi(m_rhi_global_resource.device)->bind_to_unit(location);
+        }
+
+        m_rhi_global_resource.pipeline_state->state = material->get_pipeline_state();
+        m_rhi_global_resource.pipeline_state->apply();
+
+        material->modify_shader_uniform(shader->rhi(m_rhi_global_resource.device));
+        shader->rhi(m_rhi_global_resource.device)->modify_uniform("model", swap_object.model_matrix);
+        shader->rhi(m_rhi_global_resource.device)->update_uniforms();
+
+        m_rhi_global_resource.renderer->draw(
+            shader->rhi(m_rhi_global_resource.device),
+            geometry->rhi(m_rhi_global_resource.device),
+            m_frame_buffer->rhi(m_rhi_global_resource.device)
+        );
     }
 };
 
@@ -17,6 +17,8 @@ public:
 
     struct Resource_flow {
         std::shared_ptr<Texture> texture_in{};
+        // the window's screen buffer when null
+        std::shared_ptr<Frame_buffer> frame_buffer_out{};
     };
 
     static std::shared_ptr<Postprocess_pass> create(
@@ -54,7 +56,12 @@ public:
     }
 
     void excute() override {
-        m_rhi_global_resource.renderer->clear(m_rhi_global_resource.screen_buffer);
+        std::shared_ptr<RHI_frame_buffer_base> frame_buffer = m_rhi_global_resource.screen_buffer;
+        if (m_resource_flow.frame_buffer_out) {
+            frame_buffer = m_resource_flow.frame_buffer_out->rhi(m_rhi_global_resource.device);
+        }
+
+        m_rhi_global_resource.renderer->clear(frame_buffer);
 
         auto shader = m_gamma_material->get_shader_program();
         auto texture_map = m_gamma_material->get_texture_map();
@@ -68,7 +75,7 @@ public:
         m_rhi_global_resource.renderer->draw(
             shader->rhi(m_rhi_global_resource.device),
             m_screen_geometry->rhi(m_rhi_global_resource.device),
-            m_rhi_global_resource.screen_buffer
+            frame_buffer
         );
     }
 
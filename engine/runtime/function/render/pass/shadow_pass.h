@@ -5,9 +5,12 @@
 #include "engine/runtime/function/render/material/shadow/shadow_caster_material.h"
 #include "engine/runtime/function/render/frontend/texture.h"
 #include "engine/runtime/function/render/pass/base_pass.h"
+#include "engine/runtime/function/render/utils/frustum_culler.h"
+#include "engine/runtime/tool/math.h"
 
 #include <cstddef>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -17,7 +20,13 @@ class Shadow_pass : public Base_pass {
 public:
 
     struct Execution_context {
-        std::vector<Swap_shadow_caster_renderable_object> shadow_caster_swap_objects{};
+        std::span<const Swap_renderable_object> render_swap_objects{};
+        std::span<const uint32_t> shadow_caster_indices{};
+        std::span<const Swap_renderable_object> static_render_swap_objects{};
+        std::span<const uint32_t> static_shadow_caster_indices{};
+        // the light's, casters outside are not drawn
+        bool is_frustum_culling{false};
+        Frustum frustum{};
     };
 
     struct Resource_flow {
@@ -35,6 +44,9 @@ protected:
     Execution_context m_context{};
     Resource_flow m_resource_flow{};
 
+    Frustum_culler m_frustum_culler{};
+    std::vector<uint32_t> m_visible_indices{};
+
 public:
 
     Shadow_pass(
@@ -65,18 +77,40 @@ public:
         m_context = context;
     }
 
+    // of the last excute(), empty without frustum culling
+    const Culling_stats& culling_stats() const { return m_frustum_culler.stats(); }
+
     void excute() {
+        m_frustum_culler.reset_stats();
 
         m_rhi_global_resource.renderer->clear(m_frame_buffer->rhi(m_rhi_global_resource.device));
 
         m_rhi_global_resource.pipeline_state->state = m_shadow_caster_material->get_pipeline_state();
         m_rhi_global_resource.pipeline_state->apply();
 
+        draw_casters(m_context.static_render_swap_objects, m_context.static_shadow_caster_indices);
+        draw_casters(m_context.render_swap_objects, m_context.shadow_caster_indices);
+    }
+
+private:
+    void draw_casters(
+        std::span<const Swap_renderable_object> swap_objects,
+        std::span<const uint32_t> caster_indices
+    ) {
         auto shader = m_shadow_caster_material->get_shader_program();
+        auto& geometry_table = *Geometry_table::get_instance();
+
+        if (m_context.is_frustum_culling) {
+            m_frustum_culler.cull(m_context.frustum, swap_objects, caster_indices, m_visible_indices);
+            caster_indices = m_visible_indices;
+        }
 
-        for (auto& swap_object : m_context.shadow_caster_swap_objects) {
-            
-            auto geometry = swap_object.geometry;
+        for (auto index : caster_indices) {
+            auto& swap_object = swap_objects[index];
+            auto geometry = geometry_table.get(swap_object.geometry);
+            if (!geometry) {
+                continue;
+            }
             shader->rhi(m_rhi_global_resource.device)->modify_uniform("model", swap_object.model_matrix);
             shader->rhi(m_rhi_global_resource.device)->update_uniforms();
 
@@ -9,12 +9,17 @@
 #include "engine/runtime/function/render/pass/postprocess_pass.h"
 #include "engine/runtime/function/render/pass/shadow_pass.h"
 #include "engine/runtime/function/render/pipeline/base_pipeline.h"
+#include "engine/runtime/function/render/render_scene.h"
 #include "engine/runtime/function/render/struct/camera_render_struct.h"
 #include "engine/runtime/function/render/struct/light_render_struct.h"
+#include "engine/runtime/function/render/utils/frustum_culler.h"
+#include "engine/runtime/function/render/utils/occlusion_culler.h"
 #include "engine/runtime/platform/rhi/rhi_shader_code.h"
 #include "engine/runtime/resource/resource_manager.h"
+#include "engine/runtime/tool/math.h"
 #include "glm/fwd.hpp"
 #include <memory>
+#include <span>
 
 namespace rtr {
 
@@ -33,6 +38,9 @@ private:
     std::shared_ptr<Main_pass> m_main_pass{};
     std::shared_ptr<Postprocess_pass> m_postprocess_pass{};
     std::shared_ptr<Shadow_pass> m_shadow_pass{};
+
+    bool m_is_frustum_culling{true};
+    bool m_is_occlusion_culling{false};
     
 public:
     Forward_pipeline (
@@ -54,12 +62,28 @@ public:
         return m_parallax_setting;
     }
 
+    // culls against the camera in the main pass and the light in the shadow pass
+    bool is_frustum_culling() const { return m_is_frustum_culling; }
+    void set_frustum_culling(bool is_frustum_culling) { m_is_frustum_culling = is_frustum_culling; }
+
+    const Culling_stats& main_culling_stats() const { return m_main_pass->culling_stats(); }
+    const Culling_stats& shadow_culling_stats() const { return m_shadow_pass->culling_stats(); }
+
+    // skips what the largest visible objects hide from the camera, rasterizing them on the CPU
+    bool is_occlusion_culling() const { return m_is_occlusion_culling; }
+    void set_occlusion_culling(bool is_occlusion_culling) { m_is_occlusion_culling = is_occlusion_culling; }
+
+    const Occlusion_stats& main_occlusion_stats() const { return m_main_pass->occlusion_stats(); }
+
     void update_render_resource(const Render_tick_context& tick_context) override {
 
-        m_render_resource_manager.add("main_color_attachment", Texture_2D::create_color_attachemnt_rgba(
-            m_rhi_global_resource.window->width(), 
-            m_rhi_global_resource.window->height()
-        ));
+        int width = m_rhi_global_resource.window->width();
+        int height = m_rhi_global_resource.window->height();
+        if (tick_context.target) {
+            width = tick_context.target->width();
+            height = tick_context.target->height();
+        }
+        m_render_resource_manager.add("main_color_attachment", Texture_2D::create_color_attachemnt_rgba(width, height));
 
         auto dl_shadow_map = tick_context.render_swap_data.dl_shadow_casters.shadow_map;
         auto dl_shadow_map_rhi = dl_shadow_map->rhi(m_rhi_global_resource.device);
@@ -163,26 +187,59 @@ public:
     }
 
     void update_render_pass(const Render_tick_context& tick_context) override {
+        std::span<const Swap_renderable_object> static_render_swap_objects{};
+        std::span<const uint32_t> static_shadow_caster_indices{};
+        if (const auto& static_list = tick_context.render_swap_data.static_render_list) {
+            static_render_swap_objects = static_list->render_objects;
+            static_shadow_caster_indices = static_list->shadow_caster_indices;
+        }
 
         m_shadow_pass->set_resource_flow(Shadow_pass::Resource_flow{
             .shadow_map_out = m_render_resource_manager.get<Texture_2D>("shadow_map")
         });
+        std::span<const Swap_renderable_object> render_swap_objects{};
+        std::span<const uint32_t> shadow_caster_indices{};
+        if (tick_context.render_scene) {
+            render_swap_objects = tick_context.render_scene->render_objects();
+            shadow_caster_indices = tick_context.render_scene->shadow_caster_indices();
+        } else {
+            render_swap_objects = tick_context.render_swap_data.render_objects;
+            shadow_caster_indices = tick_context.render_swap_data.update_shadow_caster_indices();
+        }
+
         m_shadow_pass->set_context(Shadow_pass::Execution_context{
-            .shadow_caster_swap_objects = tick_context.render_swap_data.get_shadow_casters(),
+            .render_swap_objects = render_swap_objects,
+            .shadow_caster_indices = shadow_caster_indices,
+            .static_render_swap_objects = static_render_swap_objects,
+            .static_shadow_caster_indices = static_shadow_caster_indices,
+            .is_frustum_culling = m_is_frustum_culling && tick_context.render_swap_data.dl_shadow_casters.shadow_map != nullptr,
+            .frustum = Frustum::from_matrix(
+                tick_context.render_swap_data.dl_shadow_casters.shadow_camera.projection_matrix *
+                tick_context.render_swap_data.dl_shadow_casters.shadow_camera.view_matrix
+            )
         });
 
         m_main_pass->set_resource_flow(Main_pass::Resource_flow{
             .color_attachment_out = m_render_resource_manager.get<Texture_2D>("main_color_attachment"),
             .shadow_map_in = m_render_resource_manager.get<Texture_2D>("shadow_map")
         });
+        auto camera_view_projection =
+            tick_context.render_swap_data.camera.projection_matrix *
+            tick_context.render_swap_data.camera.view_matrix;
         m_main_pass->set_context(Main_pass::Execution_context{
             .skybox = tick_context.render_swap_data.skybox,
-            .render_swap_objects = tick_context.render_swap_data.render_objects
+            .render_swap_objects = render_swap_objects,
+            .static_render_swap_objects = static_render_swap_objects,
+            .is_frustum_culling = m_is_frustum_culling && tick_context.render_swap_data.has_camera,
+            .frustum = Frustum::from_matrix(camera_view_projection),
+            .is_occlusion_culling = m_is_occlusion_culling && tick_context.render_swap_data.has_camera,
+            .view_projection = camera_view_projection
         });
         
         m_postprocess_pass->set_context(Postprocess_pass::Execution_context{});
         m_postprocess_pass->set_resource_flow(Postprocess_pass::Resource_flow{
-            .texture_in = m_render_resource_manager.get<Texture_2D>("main_color_attachment")
+            .texture_in = m_render_resource_manager.get<Texture_2D>("main_color_attachment"),
+            .frame_buffer_out = tick_context.target
         });
     }
 
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "engine/runtime/context/swap/renderable_object.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace rtr {
+
+// Render side copy of the renderable objects of the current scene, kept up to date by
+// applying the change journals of incremental swap buffers instead of being rebuilt
+// from a full snapshot every frame. Objects are dense and unordered: a removal moves
+// the last object into the freed place.
+class Render_scene {
+private:
+    std::vector<Swap_renderable_object> m_render_objects{};
+    std::unordered_map<uint32_t, uint32_t> m_index_of{};
+
+    std::vector<uint32_t> m_shadow_caster_indices{};
+    bool m_is_shadow_caster_dirty{true};
+
+    // objects written by the last apply(), e.g. to upload only those to an instance buffer
+    std::vector<uint32_t> m_changed_indices{};
+    std::size_t m_removed_count{0};
+
+public:
+    Render_scene() = default;
+    ~Render_scene() = default;
+
+    void apply(std::span<const Swap_render_change> changes) {
+        m_changed_indices.clear();
+        m_removed_count = 0;
+
+        for (const auto& change : changes) {
+            switch (change.type) {
+                case Swap_render_change_type::ADDED:
+                case Swap_render_change_type::CHANGED: {
+                    auto [it, is_inserted] = m_index_of.try_emplace(change.object.object_id, static_cast<uint32_t>(m_render_objects.size()));
+                    if (is_inserted) {
+                        m_render_objects.push_back(change.object);
+                    } else {
+                        m_render_objects[it->second] = change.object;
+                    }
+                    m_changed_indices.push_back(it->second);
+                    m_is_shadow_caster_dirty = true;
+                    break;
+                }
+                case Swap_render_change_type::TRANSFORMED: {
+                    auto it = m_index_of.find(change.object.object_id);
+                    if (it == m_index_of.end()) {
+                        break;
+                    }
+                    m_render_objects[it->second].model_matrix = change.object.model_matrix;
+                    m_changed_indices.push_back(it->second);
+                    break;
+                }
+                case Swap_render_change_type::REMOVED: {
+                    remove(change.object.object_id);
+                    break;
+                }
+            }
+        }
+
+        std::erase_if(m_changed_indices, [&](uint32_t index) { return index >= m_render_objects.size(); });
+        std::sort(m_changed_indices.begin(), m_changed_indices.end());
+        m_changed_indices.erase(std::unique(m_changed_indices.begin(), m_changed_indices.end()), m_changed_indices.end());
+    }
+
+    void clear() {
+        m_render_objects.clear();
+        m_index_of.clear();
+        m_shadow_caster_indices.clear();
+        m_is_shadow_caster_dirty = false;
+        m_changed_indices.clear();
+        m_removed_count = 0;
+    }
+
+    std::span<const Swap_renderable_object> render_objects() const { return m_render_objects; }
+
+    // indices into render_objects() of the shadow casting objects, only rebuilt when the
+    // set of objects or their shadow flags changed
+    std::span<const uint32_t> shadow_caster_indices() {
+        if (m_is_shadow_caster_dirty) {
+            m_shadow_caster_indices.clear();
+            for (uint32_t i = 0; i < m_render_objects.size(); i++) {
+                if (m_render_objects[i].is_cast_shadow) {
+                    m_shadow_caster_indices.push_back(i);
+                }
+            }
+            m_is_shadow_caster_dirty = false;
+        }
+        return m_shadow_caster_indices;
+    }
+
+    // sorted indices of the objects the last apply() wrote to, including the ones a
+    // removal moved; with removed_count() that is all a GPU side copy has to upload
+    std::span<const uint32_t> changed_indices() const { return m_changed_indices; }
+    std::size_t removed_count() const { return m_removed_count; }
+
+    std::size_t size() const { return m_render_objects.size(); }
+
+private:
+    void remove(uint32_t object_id) {
+        auto it = m_index_of.find(object_id);
+        if (it == m_index_of.end()) {
+            return;
+        }
+
+        auto index = it->second;
+        m_index_of.erase(it);
+        auto last_index = static_cast<uint32_t>(m_render_objects.size() - 1);
+        if (index != last_index) {
+            m_render_objects[index] = m_render_objects[last_index];
+            m_index_of[m_render_objects[index].object_id] = index;
+            m_changed_indices.push_back(index);
+        }
+        m_render_objects.pop_back();
+        m_removed_count++;
+        m_is_shadow_caster_dirty = true;
+    }
+};
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/runtime/function/render/pipeline/base_pipeline.h"
+#include "engine/runtime/function/render/render_scene.h"
 #include "engine/runtime/platform/rhi/rhi_device.h"
 #include <memory>
 
@@ -11,6 +12,7 @@ class Render_system {
 protected:
     RHI_global_resource m_global_resource{};
     std::shared_ptr<Base_pipeline> m_render_pipeline{};
+    Render_scene m_render_scene{};
 
 public:
     Render_system(
@@ -34,15 +36,26 @@ public:
         return m_global_resource;
     }
 
+    // a pipeline may be shared by several render systems that tick one after another
     void set_render_pipeline(const std::shared_ptr<Base_pipeline>& pipeline) {
         m_render_pipeline = pipeline;
     }
 
+    const std::shared_ptr<Base_pipeline>& render_pipeline() const { return m_render_pipeline; }
+
+    const Render_scene& render_scene() const { return m_render_scene; }
+
     void tick(const Render_tick_context& tick_context) {
-        m_render_pipeline->update_render_resource(tick_context);
-        m_render_pipeline->update_ubo(tick_context);
-        m_render_pipeline->update_render_pass(tick_context);
-        m_render_pipeline->execute(tick_context);
+        auto context = tick_context;
+        if (context.render_swap_data.is_incremental) {
+            m_render_scene.apply(context.render_swap_data.render_changes);
+            context.render_scene = &m_render_scene;
+        }
+
+        m_render_pipeline->update_render_resource(context);
+        m_render_pipeline->update_ubo(context);
+        m_render_pipeline->update_render_pass(context);
+        m_render_pipeline->execute(context);
     }
 
 };
@@ -0,0 +1,416 @@
+#pragma once
+
+#include "engine/runtime/tool/job_system.h"
+#include "engine/runtime/tool/math.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rtr {
+
+// Low resolution depth-only rasterizer for occlusion culling on the CPU. Meshes
+// added between clear() and rasterize() are moved to clip space, clipped against
+// the near plane and binned into 32x32 pixel tiles; the tiles are then filled in
+// parallel, four pixels at a time.
+//
+// Coverage is sampled at pixel centers, so neighbouring triangles leave no cracks,
+// and a covered pixel takes the farthest depth the triangle's plane has in it.
+// A silhouette can still cover up to half a pixel too much; is_occluded() makes up
+// for it by testing one pixel more around the projected box, against the box's
+// nearest depth, which is why the buffer has a pixel of guard band around the
+// viewport. Depth is window z in [0, 1], 1 being empty.
+class Depth_rasterizer {
+public:
+    static constexpr int tile_size = 32;
+    static constexpr int guard_band = 1;
+
+    // positions and indices must outlive rasterize(); transform takes them to clip space
+    struct Mesh {
+        glm::mat4 transform{1.0f};
+        const glm::vec3* positions{};
+        std::size_t vertex_count{};
+        const uint32_t* indices{};
+        std::size_t index_count{};
+    };
+
+private:
+    // x, y in pixels and z in [0, 1]
+    struct Screen_triangle {
+        glm::vec3 v0{}, v1{}, v2{};
+    };
+
+    struct Mesh_setup {
+        std::vector<glm::vec4> clip_positions{};
+        std::vector<Screen_triangle> triangles{};
+        std::vector<std::vector<uint32_t>> bins{};
+    };
+
+    int m_width{};
+    int m_height{};
+    // the viewport and its guard band
+    int m_buffer_width{};
+    int m_buffer_height{};
+    int m_tiles_x{};
+    int m_tiles_y{};
+    // rows are padded to whole tiles so that four pixel stores never leave them
+    int m_stride{};
+
+    std::vector<float> m_depth{};
+    std::vector<float> m_tile_max_depth{};
+
+    std::vector<Mesh> m_meshes{};
+    std::vector<Mesh_setup> m_setups{};
+    std::size_t m_triangle_count{};
+
+public:
+    Depth_rasterizer(int width = 320, int height = 180) :
+        m_width(std::max(width, 1)),
+        m_height(std::max(height, 1)) {
+        m_buffer_width = m_width + 2 * guard_band;
+        m_buffer_height = m_height + 2 * guard_band;
+        m_tiles_x = (m_buffer_width + tile_size - 1) / tile_size;
+        m_tiles_y = (m_buffer_height + tile_size - 1) / tile_size;
+        m_stride = m_tiles_x * tile_size;
+        m_depth.assign(static_cast<std::size_t>(m_stride) * m_tiles_y * tile_size, 1.0f);
+        m_tile_max_depth.assign(static_cast<std::size_t>(m_tiles_x) * m_tiles_y, 1.0f);
+    }
+
+    ~Depth_rasterizer() = default;
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    // x, y within the viewport
+    float depth(int x, int y) const {
+        return m_depth[static_cast<std::size_t>(y + guard_band) * m_stride + x + guard_band];
+    }
+    // triangles that reached the tiles in the last rasterize()
+    std::size_t triangle_count() const { return m_triangle_count; }
+
+    void clear() {
+        m_meshes.clear();
+        m_triangle_count = 0;
+        std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+        std::fill(m_tile_max_depth.begin(), m_tile_max_depth.end(), 1.0f);
+    }
+
+    void add_mesh(const Mesh& mesh) {
+        if (mesh.positions && mesh.indices && mesh.index_count >= 3) {
+            m_meshes.push_back(mesh);
+        }
+    }
+
+    void rasterize() {
+        if (m_meshes.empty()) {
+            return;
+        }
+
+        if (m_setups.size() < m_meshes.size()) {
+            m_setups.resize(m_meshes.size());
+        }
+
+        auto& job_system = *Job_sys::get_instance();
+        job_system.parallel_for(m_meshes.size(), 1, [this](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; i++) {
+                setup(m_meshes[i], m_setups[i]);
+            }
+        });
+
+        m_triangle_count = 0;
+        for (std::size_t i = 0; i < m_meshes.size(); i++) {
+            m_triangle_count += m_setups[i].triangles.size();
+        }
+
+        job_system.parallel_for(m_tile_max_depth.size(), 1, [this](std::size_t begin, std::size_t end) {
+            for (auto tile = begin; tile < end; tile++) {
+                rasterize_tile(static_cast<int>(tile));
+            }
+        });
+    }
+
+    // true when every pixel around the projected box already holds something nearer than it;
+    // boxes crossing the near plane or off the screen are never occluded
+    bool is_occluded(const glm::mat4& transform, const Bouding_box& box) const {
+        if (box.is_empty()) {
+            return false;
+        }
+
+        std::array<glm::vec3, 8> corners{};
+        for (int i = 0; i < 8; i++) {
+            corners[i] = glm::vec3(
+                (i & 1) ? box.max.x : box.min.x,
+                (i & 2) ? box.max.y : box.min.y,
+                (i & 4) ? box.max.z : box.min.z
+            );
+        }
+        std::array<glm::vec4, 8> clip{};
+        simd::transform_points(transform, corners.data(), clip.data(), corners.size());
+
+        glm::vec3 min_window(std::numeric_limits<float>::max());
+        glm::vec3 max_window(std::numeric_limits<float>::lowest());
+        for (const auto& position : clip) {
+            if (position.w <= EPSILON || position.z < -position.w) {
+                return false;
+            }
+            auto window = to_window(position);
+            min_window = glm::min(min_window, window);
+            max_window = glm::max(max_window, window);
+        }
+
+        int x0 = std::max(static_cast<int>(std::floor(min_window.x)) - 1, 0);
+        int y0 = std::max(static_cast<int>(std::floor(min_window.y)) - 1, 0);
+        int x1 = std::min(static_cast<int>(std::floor(max_window.x)) + 1, m_buffer_width - 1);
+        int y1 = std::min(static_cast<int>(std::floor(max_window.y)) + 1, m_buffer_height - 1);
+        if (x0 > x1 || y0 > y1) {
+            return false;
+        }
+
+        auto box_depth = min_window.z;
+        for (int tile_y = y0 / tile_size; tile_y <= y1 / tile_size; tile_y++) {
+            for (int tile_x = x0 / tile_size; tile_x <= x1 / tile_size; tile_x++) {
+                if (m_tile_max_depth[tile_y * m_tiles_x + tile_x] <= box_depth) {
+                    continue;
+                }
+
+                int tx0 = std::max(x0, tile_x * tile_size), tx1 = std::min(x1, tile_x * tile_size + tile_size - 1);
+                int ty0 = std::max(y0, tile_y * tile_size), ty1 = std::min(y1, tile_y * tile_size + tile_size - 1);
+                for (int y = ty0; y <= ty1; y++) {
+                    if (!is_row_occluded(&m_depth[static_cast<std::size_t>(y) * m_stride], tx0, tx1, box_depth)) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    glm::vec3 to_window(const glm::vec4& clip) const {
+        auto ndc = glm::vec3(clip) / clip.w;
+        return glm::vec3(
+            (ndc.x * 0.5f + 0.5f) * m_width + guard_band,
+            (ndc.y * 0.5f + 0.5f) * m_height + guard_band,
+            ndc.z * 0.5f + 0.5f
+        );
+    }
+
+    static bool is_row_occluded(const float* row, int x0, int x1, float box_depth) {
+        int x = x0;
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+        auto depth = _mm_set1_ps(box_depth);
+        for (; x + 3 <= x1; x += 4) {
+            if (_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(row + x), depth)) != 0) {
+                return false;
+            }
+        }
+#endif
+        for (; x <= x1; x++) {
+            if (row[x] > box_depth) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void setup(const Mesh& mesh, Mesh_setup& out) const {
+        out.clip_positions.resize(mesh.vertex_count);
+        simd::transform_points(mesh.transform, mesh.positions, out.clip_positions.data(), mesh.vertex_count);
+
+        out.triangles.clear();
+        out.bins.resize(m_tile_max_depth.size());
+        for (auto& bin : out.bins) {
+            bin.clear();
+        }
+
+        const auto& clip = out.clip_positions;
+        for (std::size_t i = 0; i + 2 < mesh.index_count; i += 3) {
+            auto i0 = mesh.indices[i], i1 = mesh.indices[i + 1], i2 = mesh.indices[i + 2];
+            if (i0 >= mesh.vertex_count || i1 >= mesh.vertex_count || i2 >= mesh.vertex_count) {
+                continue;
+            }
+            const auto& a = clip[i0];
+            const auto& b = clip[i1];
+            const auto& c = clip[i2];
+
+            // all three outside the same plane
+            if ((a.x > a.w && b.x > b.w && c.x > c.w) || (a.x < -a.w && b.x < -b.w && c.x < -c.w) ||
+                (a.y > a.w && b.y > b.w && c.y > c.w) || (a.y < -a.w && b.y < -b.w && c.y < -c.w) ||
+                (a.z > a.w && b.z > b.w && c.z > c.w)) {
+                continue;
+            }
+
+            if (a.z >= -a.w && b.z >= -b.w && c.z >= -c.w) {
+                bin_triangle(a, b, c, out);
+                continue;
+            }
+
+            // clip the polygon against the near plane z = -w, a triangle becomes at most a quad
+            std::array<glm::vec4, 3> input{a, b, c};
+            std::array<glm::vec4, 4> polygon{};
+            int count = 0;
+            for (int j = 0; j < 3; j++) {
+                const auto& current = input[j];
+                const auto& next = input[(j + 1) % 3];
+                auto current_distance = current.z + current.w;
+                auto next_distance = next.z + next.w;
+                if (current_distance >= 0.0f) {
+                    polygon[count++] = current;
+                }
+                if ((current_distance >= 0.0f) != (next_distance >= 0.0f)) {
+                    auto t = current_distance / (current_distance - next_distance);
+                    polygon[count++] = current + (next - current) * t;
+                }
+            }
+            for (int j = 1; j + 1 < count; j++) {
+                bin_triangle(polygon[0], polygon[j], polygon[j + 1], out);
+            }
+        }
+    }
+
+    void bin_triangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c, Mesh_setup& out) const {
+        if (a.w <= EPSILON || b.w <= EPSILON || c.w <= EPSILON) {
+            return;
+        }
+
+        Screen_triangle triangle{to_window(a), to_window(b), to_window(c)};
+        auto area = edge_area(triangle.v0, triangle.v1, triangle.v2);
+        if (!(std::abs(area) > EPSILON)) {
+            return;
+        }
+
+        auto min_x = std::min({triangle.v0.x, triangle.v1.x, triangle.v2.x});
+        auto max_x = std::max({triangle.v0.x, triangle.v1.x, triangle.v2.x});
+        auto min_y = std::min({triangle.v0.y, triangle.v1.y, triangle.v2.y});
+        auto max_y = std::max({triangle.v0.y, triangle.v1.y, triangle.v2.y});
+        if (max_x < 0.0f || max_y < 0.0f || min_x > m_buffer_width || min_y > m_buffer_height) {
+            return;
+        }
+
+        int tile_x0 = std::max(static_cast<int>(min_x) / tile_size, 0);
+        int tile_y0 = std::max(static_cast<int>(min_y) / tile_size, 0);
+        int tile_x1 = std::min(static_cast<int>(std::min(max_x, static_cast<float>(m_buffer_width - 1))) / tile_size, m_tiles_x - 1);
+        int tile_y1 = std::min(static_cast<int>(std::min(max_y, static_cast<float>(m_buffer_height - 1))) / tile_size, m_tiles_y - 1);
+
+        auto index = static_cast<uint32_t>(out.triangles.size());
+        out.triangles.push_back(triangle);
+        for (int tile_y = tile_y0; tile_y <= tile_y1; tile_y++) {
+            for (int tile_x = tile_x0; tile_x <= tile_x1; tile_x++) {
+                out.bins[tile_y * m_tiles_x + tile_x].push_back(index);
+            }
+        }
+    }
+
+    static float edge_area(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2) {
+        return (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+    }
+
+    void rasterize_tile(int tile) {
+        int tile_x = tile % m_tiles_x;
+        int tile_y = tile / m_tiles_x;
+        int x0 = tile_x * tile_size, x1 = std::min(x0 + tile_size, m_buffer_width) - 1;
+        int y0 = tile_y * tile_size, y1 = std::min(y0 + tile_size, m_buffer_height) - 1;
+
+        // in submission order, so the result does not depend on the scheduling
+        for (std::size_t i = 0; i < m_meshes.size(); i++) {
+            const auto& setup = m_setups[i];
+            for (auto index : setup.bins[tile]) {
+                rasterize_triangle(setup.triangles[index], x0, y0, x1, y1);
+            }
+        }
+
+        float max_depth = 0.0f;
+        for (int y = y0; y <= y1; y++) {
+            const auto* row = &m_depth[static_cast<std::size_t>(y) * m_stride];
+            for (int x = x0; x <= x1; x++) {
+                max_depth = std::max(max_depth, row[x]);
+            }
+        }
+        m_tile_max_depth[tile] = max_depth;
+    }
+
+    void rasterize_triangle(Screen_triangle triangle, int x0, int y0, int x1, int y1) {
+        auto area = edge_area(triangle.v0, triangle.v1, triangle.v2);
+        if (area < 0.0f) {
+            std::swap(triangle.v1, triangle.v2);
+            area = -area;
+        }
+        const auto& v0 = triangle.v0;
+        const auto& v1 = triangle.v1;
+        const auto& v2 = triangle.v2;
+
+        // e(x, y) = a x + b y + c, not negative inside
+        std::array<float, 3> a{}, b{}, c{};
+        auto set_edge = [&](int i, const glm::vec3& p, const glm::vec3& q) {
+            a[i] = p.y - q.y;
+            b[i] = q.x - p.x;
+            c[i] = -(a[i] * p.x + b[i] * p.y);
+        };
+        set_edge(0, v0, v1);
+        set_edge(1, v1, v2);
+        set_edge(2, v2, v0);
+
+        // depth plane through the vertices, taken at the pixel's farthest corner
+        auto dz1 = v1.z - v0.z, dz2 = v2.z - v0.z;
+        auto dzdx = (dz1 * (v2.y - v0.y) - dz2 * (v1.y - v0.y)) / area;
+        auto dzdy = (dz2 * (v1.x - v0.x) - dz1 * (v2.x - v0.x)) / area;
+        auto z_origin = v0.z - dzdx * v0.x - dzdy * v0.y + 0.5f * (std::abs(dzdx) + std::abs(dzdy));
+        auto z_max = std::max({v0.z, v1.z, v2.z});
+
+        int min_x = std::max(x0, static_cast<int>(std::floor(std::min({v0.x, v1.x, v2.x}))));
+        int max_x = std::min(x1, static_cast<int>(std::floor(std::max({v0.x, v1.x, v2.x}))));
+        int min_y = std::max(y0, static_cast<int>(std::floor(std::min({v0.y, v1.y, v2.y}))));
+        int max_y = std::min(y1, static_cast<int>(std::floor(std::max({v0.y, v1.y, v2.y}))));
+        if (min_x > max_x || min_y > max_y) {
+            return;
+        }
+        // tiles start at multiples of 4 and rows are padded, so aligned groups stay in the row
+        min_x &= ~3;
+
+        for (int y = min_y; y <= max_y; y++) {
+            auto* row = &m_depth[static_cast<std::size_t>(y) * m_stride];
+            auto center_y = static_cast<float>(y) + 0.5f;
+            int x = min_x;
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+            auto step = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+            auto a0 = _mm_set1_ps(a[0]), a1 = _mm_set1_ps(a[1]), a2 = _mm_set1_ps(a[2]);
+            auto row0 = _mm_set1_ps(b[0] * center_y + c[0]);
+            auto row1 = _mm_set1_ps(b[1] * center_y + c[1]);
+            auto row2 = _mm_set1_ps(b[2] * center_y + c[2]);
+            auto z_dx = _mm_set1_ps(dzdx);
+            auto z_row = _mm_set1_ps(z_origin + dzdy * center_y);
+            auto z_limit = _mm_set1_ps(z_max);
+            auto zero = _mm_setzero_ps();
+            for (; x <= max_x; x += 4) {
+                auto center_x = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), step);
+                auto inside = _mm_and_ps(
+                    _mm_and_ps(
+                        _mm_cmpge_ps(simd::detail::madd(a0, center_x, row0), zero),
+                        _mm_cmpge_ps(simd::detail::madd(a1, center_x, row1), zero)
+                    ),
+                    _mm_cmpge_ps(simd::detail::madd(a2, center_x, row2), zero)
+                );
+                if (_mm_movemask_ps(inside) == 0) {
+                    continue;
+                }
+                auto z = _mm_min_ps(simd::detail::madd(z_dx, center_x, z_row), z_limit);
+                auto old_depth = _mm_loadu_ps(row + x);
+                _mm_storeu_ps(row + x, _mm_blendv_ps(old_depth, _mm_min_ps(old_depth, z), inside));
+            }
+#endif
+            for (; x <= max_x; x++) {
+                auto center_x = static_cast<float>(x) + 0.5f;
+                if (a[0] * center_x + b[0] * center_y + c[0] >= 0.0f &&
+                    a[1] * center_x + b[1] * center_y + c[1] >= 0.0f &&
+                    a[2] * center_x + b[2] * center_y + c[2] >= 0.0f) {
+                    auto z = std::min(z_origin + dzdx * center_x + dzdy * center_y, z_max);
+                    row[x] = std::min(row[x], z);
+                }
+            }
+        }
+    }
+};
+
+}
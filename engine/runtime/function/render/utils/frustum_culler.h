@@ -0,0 +1,106 @@
+#pragma once
+
+#include "engine/runtime/context/swap/renderable_object.h"
+#include "engine/runtime/function/render/frontend/geometry.h"
+#include "engine/runtime/tool/math.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace rtr {
+
+struct Culling_stats {
+    std::size_t tested{};
+    std::size_t visible{};
+
+    std::size_t culled() const { return tested - visible; }
+};
+
+// Culling stage run by a pass before it submits draws: every object's cached
+// Geometry::bounding_sphere() is moved to world space with its model matrix, then
+// the spheres are tested against the frustum in batches by simd::cull_spheres.
+// Statistics add up over the calls until reset_stats().
+class Frustum_culler {
+private:
+    std::vector<glm::vec4> m_spheres{};
+    std::vector<uint8_t> m_is_visible{};
+    Culling_stats m_stats{};
+
+public:
+    Frustum_culler() = default;
+    ~Frustum_culler() = default;
+
+    const Culling_stats& stats() const { return m_stats; }
+    void reset_stats() { m_stats = Culling_stats{}; }
+
+    // visible_indices = indices into objects of the objects inside the frustum, in order
+    void cull(
+        const Frustum& frustum,
+        std::span<const Swap_renderable_object> objects,
+        std::vector<uint32_t>& visible_indices
+    ) {
+        m_spheres.resize(objects.size());
+        for (std::size_t i = 0; i < objects.size(); i++) {
+            m_spheres[i] = world_sphere(objects[i]);
+        }
+        test(frustum, visible_indices, [](std::size_t i) { return static_cast<uint32_t>(i); });
+    }
+
+    // like the above, but only for the objects at indices
+    void cull(
+        const Frustum& frustum,
+        std::span<const Swap_renderable_object> objects,
+        std::span<const uint32_t> indices,
+        std::vector<uint32_t>& visible_indices
+    ) {
+        m_spheres.resize(indices.size());
+        for (std::size_t i = 0; i < indices.size(); i++) {
+            m_spheres[i] = world_sphere(objects[indices[i]]);
+        }
+        test(frustum, visible_indices, [&](std::size_t i) { return indices[i]; });
+    }
+
+    // the geometry's bounding sphere as vec4(center, radius) after model
+    static glm::vec4 world_sphere(const Geometry& geometry, const glm::mat4& model) {
+        const auto& sphere = geometry.bounding_sphere();
+        auto center = glm::vec3(model * glm::vec4(sphere.center, 1.0f));
+        auto scale_squared = std::max({
+            glm::dot(glm::vec3(model[0]), glm::vec3(model[0])),
+            glm::dot(glm::vec3(model[1]), glm::vec3(model[1])),
+            glm::dot(glm::vec3(model[2]), glm::vec3(model[2]))
+        });
+        return glm::vec4(center, sphere.radius * std::sqrt(scale_squared));
+    }
+
+private:
+    template<typename Index_of>
+    void test(const Frustum& frustum, std::vector<uint32_t>& visible_indices, Index_of&& index_of) {
+        m_is_visible.resize(m_spheres.size());
+        simd::cull_spheres(frustum, m_spheres.data(), m_is_visible.data(), m_spheres.size());
+
+        visible_indices.clear();
+        for (std::size_t i = 0; i < m_is_visible.size(); i++) {
+            if (m_is_visible[i]) {
+                visible_indices.push_back(index_of(i));
+            }
+        }
+
+        m_stats.tested += m_spheres.size();
+        m_stats.visible += visible_indices.size();
+    }
+
+    // objects without geometry are left for the draw to skip
+    static glm::vec4 world_sphere(const Swap_renderable_object& object) {
+        auto geometry = Geometry_table::get_instance()->get(object.geometry);
+        if (!geometry) {
+            return glm::vec4(0.0f, 0.0f, 0.0f, std::numeric_limits<float>::infinity());
+        }
+        return world_sphere(*geometry, object.model_matrix);
+    }
+};
+
+}
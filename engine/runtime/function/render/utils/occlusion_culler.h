@@ -0,0 +1,178 @@
+#pragma once
+
+#include "engine/runtime/context/swap/renderable_object.h"
+#include "engine/runtime/function/render/frontend/geometry.h"
+#include "engine/runtime/function/render/utils/depth_rasterizer.h"
+#include "engine/runtime/function/render/utils/frustum_culler.h"
+#include "engine/runtime/tool/job_system.h"
+#include "engine/runtime/tool/math.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace rtr {
+
+struct Occlusion_stats {
+    std::size_t occluders{};
+    std::size_t occluder_triangles{};
+    std::size_t tested{};
+    std::size_t occluded{};
+
+    std::size_t visible() const { return tested - occluded; }
+};
+
+// Culling stage run after frustum culling: the opaque objects that look largest from
+// the camera are drawn as occluders into a Depth_rasterizer, then the world bounds of
+// the remaining objects are tested against its depth. A frame goes
+//
+//     begin(view_projection);
+//     add_candidates(...);    // for every list of objects
+//     rasterize_occluders();
+//     cull(...);              // for every list of objects
+//
+// Occluders are never culled themselves. Statistics are reset by begin().
+class Occlusion_culler {
+private:
+    struct Candidate {
+        const Swap_renderable_object* object{};
+        const Geometry* geometry{};
+        float screen_size{};
+    };
+
+    Depth_rasterizer m_rasterizer{};
+    glm::mat4 m_view_projection{1.0f};
+    std::vector<Candidate> m_candidates{};
+    std::vector<const Swap_renderable_object*> m_occluders{};
+    std::vector<uint8_t> m_is_occluded{};
+    Occlusion_stats m_stats{};
+
+    std::size_t m_max_occluders{32};
+    std::size_t m_max_occluder_triangles{32768};
+    // bounding sphere radius over view depth, objects smaller than this never occlude
+    float m_min_occluder_size{0.1f};
+
+public:
+    Occlusion_culler(int width = 320, int height = 180) : m_rasterizer(width, height) {}
+    ~Occlusion_culler() = default;
+
+    const Occlusion_stats& stats() const { return m_stats; }
+    const Depth_rasterizer& rasterizer() const { return m_rasterizer; }
+
+    std::size_t max_occluders() const { return m_max_occluders; }
+    void set_max_occluders(std::size_t count) { m_max_occluders = count; }
+    std::size_t max_occluder_triangles() const { return m_max_occluder_triangles; }
+    void set_max_occluder_triangles(std::size_t count) { m_max_occluder_triangles = count; }
+    float min_occluder_size() const { return m_min_occluder_size; }
+    void set_min_occluder_size(float size) { m_min_occluder_size = size; }
+
+    void begin(const glm::mat4& view_projection) {
+        m_view_projection = view_projection;
+        m_candidates.clear();
+        m_occluders.clear();
+        m_rasterizer.clear();
+        m_stats = Occlusion_stats{};
+    }
+
+    // the objects at indices may occlude, they must stay alive until the last cull() of the frame;
+    // only opaque materials occlude, translucent and alpha-mapped surfaces can be seen through
+    void add_candidates(std::span<const Swap_renderable_object> objects, std::span<const uint32_t> indices) {
+        auto& material_table = *Material_table::get_instance();
+        auto& geometry_table = *Geometry_table::get_instance();
+        const auto opaque_state = Pipeline_state::opaque_pipeline_state();
+        for (auto index : indices) {
+            const auto& object = objects[index];
+            auto material = material_table.get(object.material);
+            if (!material || material->get_pipeline_state() != opaque_state) {
+                continue;
+            }
+
+            auto geometry = geometry_table.get(object.geometry);
+            if (!geometry || !geometry->element_attribute() ||
+                geometry->element_attribute()->data_count() / 3 > m_max_occluder_triangles) {
+                continue;
+            }
+
+            auto sphere = Frustum_culler::world_sphere(*geometry, object.model_matrix);
+            auto depth = (m_view_projection * glm::vec4(glm::vec3(sphere), 1.0f)).w;
+            // around the camera, like the walls of a room
+            auto screen_size = depth > sphere.w ? sphere.w / depth : std::numeric_limits<float>::max();
+            if (screen_size >= m_min_occluder_size) {
+                m_candidates.push_back(Candidate{&object, geometry, screen_size});
+            }
+        }
+    }
+
+    // draws the largest candidates into the depth buffer, within the occluder and triangle budgets
+    void rasterize_occluders() {
+        std::sort(m_candidates.begin(), m_candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return a.screen_size > b.screen_size;
+        });
+
+        std::size_t triangle_count = 0;
+        for (const auto& candidate : m_candidates) {
+            if (m_occluders.size() >= m_max_occluders) {
+                break;
+            }
+
+            auto positions = std::dynamic_pointer_cast<Position_attribute>(candidate.geometry->attribute(0));
+            const auto& indices = candidate.geometry->element_attribute()->data();
+            if (!positions || triangle_count + indices.size() / 3 > m_max_occluder_triangles) {
+                continue;
+            }
+            triangle_count += indices.size() / 3;
+
+            m_rasterizer.add_mesh(Depth_rasterizer::Mesh{
+                m_view_projection * candidate.object->model_matrix,
+                reinterpret_cast<const glm::vec3*>(positions->data().data()),
+                positions->unit_count(),
+                indices.data(),
+                indices.size()
+            });
+            m_occluders.push_back(candidate.object);
+        }
+        std::sort(m_occluders.begin(), m_occluders.end());
+
+        m_rasterizer.rasterize();
+        m_stats.occluders = m_occluders.size();
+        m_stats.occluder_triangles = m_rasterizer.triangle_count();
+    }
+
+    // keeps the indices of the objects that are not occluded, in order
+    void cull(std::span<const Swap_renderable_object> objects, std::vector<uint32_t>& indices) {
+        if (m_occluders.empty()) {
+            m_stats.tested += indices.size();
+            return;
+        }
+
+        m_is_occluded.assign(indices.size(), 0);
+        Job_sys::get_instance()->parallel_for(indices.size(), 64, [&](std::size_t begin, std::size_t end) {
+            auto& geometry_table = *Geometry_table::get_instance();
+            for (auto i = begin; i < end; i++) {
+                const auto& object = objects[indices[i]];
+                if (std::binary_search(m_occluders.begin(), m_occluders.end(), &object)) {
+                    continue;
+                }
+                auto geometry = geometry_table.get(object.geometry);
+                if (geometry && m_rasterizer.is_occluded(m_view_projection * object.model_matrix, geometry->bounding_box())) {
+                    m_is_occluded[i] = 1;
+                }
+            }
+        });
+
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < indices.size(); i++) {
+            if (!m_is_occluded[i]) {
+                indices[count++] = indices[i];
+            }
+        }
+        m_stats.tested += indices.size();
+        m_stats.occluded += indices.size() - count;
+        indices.resize(count);
+    }
+};
+
+}
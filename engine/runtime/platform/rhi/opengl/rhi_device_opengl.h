@@ -13,6 +13,7 @@
 #include "rhi_buffer_opengl.h"
 #include "rhi_geometry_opengl.h"
 #include "rhi_window_opengl.h"
+#include "rhi_headless_window_opengl.h"
 #include "rhi_shader_code_opengl.h"
 #include "rhi_shader_program_opengl.h"
 #include "rhi_pipeline_state_opengl.h"
@@ -49,6 +50,17 @@ public:
         );
     }
 
+    std::shared_ptr<RHI_window> create_headless_window(
+        int width,
+        int height
+    ) override {
+#ifdef RTR_HAS_EGL
+        return std::make_shared<RHI_headless_window_OpenGL>(width, height);
+#else
+        throw std::runtime_error("RHI_device_OpenGL::create_headless_window: built without EGL support");
+#endif
+    }
+
     std::shared_ptr<RHI_buffer> create_vertex_buffer(
         Buffer_usage usage,
         Buffer_data_type attribute_type,
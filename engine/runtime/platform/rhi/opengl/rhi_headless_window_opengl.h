@@ -0,0 +1,162 @@
+#pragma once
+
+#include "engine/runtime/tool/base.h"
+
+#include "../rhi_window.h"
+
+#ifdef RTR_HAS_EGL
+// keep eglplatform.h from pulling in X11, whose macros clash with engine names
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <stdexcept>
+
+namespace rtr {
+
+#ifdef RTR_HAS_EGL
+
+// Window without a display connection: an EGL pbuffer surface stands in for the
+// window's default frame buffer, so the screen buffer, passes and RHI_global_resource
+// work unchanged while nothing is ever presented. Works with Mesa's software
+// drivers (llvmpipe) and the surfaceless platform on machines without X or Wayland.
+class RHI_headless_window_OpenGL : public RHI_window {
+protected:
+    EGLDisplay m_display{EGL_NO_DISPLAY};
+    EGLSurface m_surface{EGL_NO_SURFACE};
+    EGLContext m_context{EGL_NO_CONTEXT};
+    bool m_is_active{true};
+
+public:
+    RHI_headless_window_OpenGL(
+        int width,
+        int height
+    ) : RHI_window(width, height, "headless") {
+        m_display = open_display();
+        if (m_display == EGL_NO_DISPLAY) {
+            throw std::runtime_error("RHI_headless_window_OpenGL: no EGL display available");
+        }
+
+        if (!eglBindAPI(EGL_OPENGL_API)) {
+            throw std::runtime_error("RHI_headless_window_OpenGL: desktop OpenGL is not supported by EGL");
+        }
+
+        const EGLint config_attributes[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_ALPHA_SIZE, 8,
+            EGL_DEPTH_SIZE, 24,
+            EGL_NONE
+        };
+
+        EGLConfig config{};
+        EGLint config_count{};
+        if (!eglChooseConfig(m_display, config_attributes, &config, 1, &config_count) || config_count == 0) {
+            throw std::runtime_error("RHI_headless_window_OpenGL: no matching EGL config");
+        }
+
+        const EGLint surface_attributes[] = {
+            EGL_WIDTH, m_width,
+            EGL_HEIGHT, m_height,
+            EGL_NONE
+        };
+        m_surface = eglCreatePbufferSurface(m_display, config, surface_attributes);
+        if (m_surface == EGL_NO_SURFACE) {
+            throw std::runtime_error("RHI_headless_window_OpenGL: failed to create pbuffer surface");
+        }
+
+        // software drivers may stop at 4.5, which still covers the DSA calls the RHI uses
+        for (EGLint minor_version : {6, 5}) {
+            const EGLint context_attributes[] = {
+                EGL_CONTEXT_MAJOR_VERSION, 4,
+                EGL_CONTEXT_MINOR_VERSION, minor_version,
+                EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                EGL_NONE
+            };
+            m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, context_attributes);
+            if (m_context != EGL_NO_CONTEXT) {
+                break;
+            }
+        }
+        if (m_context == EGL_NO_CONTEXT) {
+            throw std::runtime_error("RHI_headless_window_OpenGL: failed to create an OpenGL 4.5+ core context");
+        }
+
+        eglMakeCurrent(m_display, m_surface, m_surface, m_context);
+
+        if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+            throw std::runtime_error("RHI_headless_window_OpenGL: failed to initialize GLAD");
+        }
+
+        set_swap_interval(Swap_interval_mode::IMMEDIATE);
+        set_viewport(0, 0, m_width, m_height);
+    }
+
+    ~RHI_headless_window_OpenGL() override {
+        if (m_display == EGL_NO_DISPLAY) {
+            return;
+        }
+        eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (m_context != EGL_NO_CONTEXT) {
+            eglDestroyContext(m_display, m_context);
+        }
+        if (m_surface != EGL_NO_SURFACE) {
+            eglDestroySurface(m_display, m_surface);
+        }
+        eglTerminate(m_display);
+    }
+
+    void set_viewport(int x, int y, int width, int height) override {
+        glViewport(x, y, width, height);
+    }
+
+    void deactivate() override {
+        m_is_active = false;
+    }
+
+    bool is_active() override {
+        return m_is_active;
+    }
+
+    // a pbuffer surface has no vsync, so every mode maps to IMMEDIATE
+    void set_swap_interval(Swap_interval_mode) override {
+        eglSwapInterval(m_display, 0);
+        m_swap_interval_mode = Swap_interval_mode::IMMEDIATE;
+    }
+
+private:
+    static EGLDisplay open_display() {
+        auto display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+            return display;
+        }
+
+        auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT")
+        );
+        if (!get_platform_display) {
+            return EGL_NO_DISPLAY;
+        }
+
+        display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+            return display;
+        }
+        return EGL_NO_DISPLAY;
+    }
+
+    void poll_events() override {}
+
+    void swap_buffers() override {
+        eglSwapBuffers(m_display, m_surface);
+    }
+
+};
+
+#endif
+
+}
@@ -179,6 +179,8 @@ public:
         glfwGetFramebufferSize(window(), &m_width, &m_height);
         set_viewport(0, 0, m_width, m_height);
 
+        set_swap_interval(m_swap_interval_mode);
+
         m_imgui = RHI_imgui_OpenGL::create(m_window);
         
     }
@@ -196,6 +198,21 @@ public:
         glfwSetWindowShouldClose(m_window, true);
     }
 
+    void set_swap_interval(Swap_interval_mode mode) override {
+        if (mode == Swap_interval_mode::ADAPTIVE && 
+            !glfwExtensionSupported("WGL_EXT_swap_control_tear") && 
+            !glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+            mode = Swap_interval_mode::VSYNC;
+        }
+
+        switch (mode) {
+            case Swap_interval_mode::IMMEDIATE: glfwSwapInterval(0); break;
+            case Swap_interval_mode::VSYNC: glfwSwapInterval(1); break;
+            case Swap_interval_mode::ADAPTIVE: glfwSwapInterval(-1); break;
+        }
+        m_swap_interval_mode = mode;
+    }
+
     GLFWwindow* window() {
         return m_window;
     }
@@ -39,6 +39,12 @@ public:
         const std::string& title
     ) = 0;
 
+    // offscreen stand-in for a window, for machines without a display
+    virtual std::shared_ptr<RHI_window> create_headless_window(
+        int width,
+        int height
+    ) = 0;
+
     virtual std::shared_ptr<RHI_buffer> create_vertex_buffer(
         Buffer_usage usage,
         Buffer_data_type attribute_type,
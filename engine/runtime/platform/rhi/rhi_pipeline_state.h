@@ -96,6 +96,8 @@ struct Depth_state {
             Depth_function::LESS_EQUAL
         };
     }
+
+    bool operator==(const Depth_state&) const = default;
 };
 
 struct Polygon_offset_state {
@@ -124,6 +126,8 @@ struct Polygon_offset_state {
             1.0f
         };
     }
+
+    bool operator==(const Polygon_offset_state&) const = default;
 };
 
 struct Stencil_state {
@@ -174,6 +178,8 @@ struct Stencil_state {
             0xff
         };
     }
+
+    bool operator==(const Stencil_state&) const = default;
 };
 
 struct Blend_state {
@@ -212,6 +218,8 @@ struct Blend_state {
         };
     }
 
+    bool operator==(const Blend_state&) const = default;
+
 };
 
 
@@ -252,6 +260,8 @@ struct Cull_state {
         };
     }
 
+    bool operator==(const Cull_state&) const = default;
+
 };
 
 
@@ -312,6 +322,8 @@ struct Pipeline_state {
             Cull_state::disabled(),
         };
     }
+
+    bool operator==(const Pipeline_state&) const = default;
 };
 
 class RHI_pipeline_state {
@@ -142,6 +142,14 @@ enum class Key_action {
 };
 
 
+// IMMEDIATE presents without waiting, VSYNC waits for the vertical blank,
+// ADAPTIVE waits unless the frame is already late (falls back to VSYNC when unsupported).
+enum class Swap_interval_mode {
+    IMMEDIATE,
+    VSYNC,
+    ADAPTIVE
+};
+
 using Window_resize_event = Event<int, int>;
 using Mouse_button_event = Event<Mouse_button, Key_action, unsigned int>;
 using Mouse_move_event = Event<double, double>;
@@ -155,6 +163,7 @@ protected:
     int m_height{};
     std::string m_title{};
     std::shared_ptr<RHI_imgui> m_imgui{};
+    Swap_interval_mode m_swap_interval_mode{Swap_interval_mode::VSYNC};
 
     Window_resize_event m_window_resize_event{[&](int width, int height) {
         Log_sys::get_instance()->log(Logging_system::Level::info, "Window resized: {} {}", width, height);
@@ -190,6 +199,9 @@ public:
 
     virtual void set_viewport(int x, int y, int width, int height) = 0;
     virtual void deactivate() = 0;
+    virtual void set_swap_interval(Swap_interval_mode mode) = 0;
+
+    Swap_interval_mode swap_interval_mode() const { return m_swap_interval_mode; }
 
     void on_frame_begin() {
         poll_events();
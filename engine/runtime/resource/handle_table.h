@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace rtr {
+
+// Trivially copyable reference into a Resource_handle_table<T>.
+template<typename T>
+struct Resource_handle {
+    static constexpr uint32_t invalid_index = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index{invalid_index};
+
+    bool is_valid() const { return index != invalid_index; }
+    bool operator==(const Resource_handle&) const = default;
+};
+
+// Stable table that keeps one shared_ptr per registered resource, so per-frame
+// records can refer to resources by index without touching reference counts.
+// Entries live in fixed chunks that never move; get() takes no lock and is safe
+// to call while another thread acquires new handles. Resources that nobody but
+// the table owns are released by collect(), called once per frame at a point
+// where neither the logic nor the render side is running.
+template<typename T>
+class Resource_handle_table {
+public:
+    static constexpr uint32_t chunk_size = 1024;
+    static constexpr uint32_t max_chunk_count = 1024;
+
+private:
+    struct Entry {
+        std::shared_ptr<T> resource{};
+        T* pointer{nullptr};
+        uint32_t unused_collections{0};
+    };
+
+    // a handle may still sit in a swap buffer for a frame or two after the last
+    // owner dropped the resource, so entries survive a couple of collections
+    static constexpr uint32_t release_after_collections = 2;
+
+    std::array<std::unique_ptr<Entry[]>, max_chunk_count> m_chunks{};
+    std::unordered_map<const T*, uint32_t> m_index_of{};
+    std::vector<uint32_t> m_free_indices{};
+    uint32_t m_next_index{0};
+    std::mutex m_mutex{};
+
+public:
+    Resource_handle_table() = default;
+    ~Resource_handle_table() = default;
+
+    Resource_handle_table(const Resource_handle_table&) = delete;
+    Resource_handle_table& operator=(const Resource_handle_table&) = delete;
+
+    Resource_handle<T> acquire(const std::shared_ptr<T>& resource) {
+        if (!resource) {
+            return Resource_handle<T>{};
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto it = m_index_of.find(resource.get()); it != m_index_of.end()) {
+            return Resource_handle<T>{it->second};
+        }
+
+        uint32_t index{};
+        if (!m_free_indices.empty()) {
+            index = m_free_indices.back();
+            m_free_indices.pop_back();
+        } else {
+            if (m_next_index == chunk_size * max_chunk_count) {
+                throw std::runtime_error("Resource_handle_table::acquire: table is full");
+            }
+            index = m_next_index++;
+            auto& chunk = m_chunks[index / chunk_size];
+            if (!chunk) {
+                chunk = std::make_unique<Entry[]>(chunk_size);
+            }
+        }
+
+        auto& entry = m_chunks[index / chunk_size][index % chunk_size];
+        entry.resource = resource;
+        entry.pointer = resource.get();
+        entry.unused_collections = 0;
+        m_index_of[entry.pointer] = index;
+        return Resource_handle<T>{index};
+    }
+
+    T* get(Resource_handle<T> handle) const {
+        if (!handle.is_valid()) {
+            return nullptr;
+        }
+        return m_chunks[handle.index / chunk_size][handle.index % chunk_size].pointer;
+    }
+
+    void collect() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (uint32_t index = 0; index < m_next_index; index++) {
+            auto& entry = m_chunks[index / chunk_size][index % chunk_size];
+            if (!entry.resource) {
+                continue;
+            }
+
+            if (entry.resource.use_count() > 1) {
+                entry.unused_collections = 0;
+                continue;
+            }
+
+            if (++entry.unused_collections < release_after_collections) {
+                continue;
+            }
+
+            m_index_of.erase(entry.pointer);
+            entry = Entry{};
+            m_free_indices.push_back(index);
+        }
+    }
+
+    std::size_t size() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_index_of.size();
+    }
+
+};
+
+}
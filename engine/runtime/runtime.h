@@ -1,9 +1,13 @@
 #pragma once
 
+#include "engine/runtime/context/swap/interpolation.h"
 #include "engine/runtime/context/tick_context/render_tick_context.h"
 #include "engine/runtime/context/tick_context/logic_tick_context.h"
+#include "engine/runtime/function/input/input_record.h"
 #include "engine/runtime/function/input/input_system.h"
 #include "engine/runtime/function/render/render_system.h"
+#include "engine/runtime/tool/frame_pacer.h"
+#include "engine/runtime/tool/job_system.h"
 #include "engine/runtime/tool/logger.h"
 #include "engine/runtime/tool/timer.h"
 #include "engine/runtime/platform/rhi/opengl/rhi_device_opengl.h"
@@ -11,37 +15,122 @@
 #include "engine/runtime/platform/rhi/rhi_device.h"
 #include "engine/runtime/platform/rhi/rhi_renderer.h"
 #include "engine/runtime/resource/file_service.h"
+#include "engine/runtime/world_instance.h"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 namespace rtr {
 
+// SERIAL ticks logic and render back to back on the calling thread.
+// THREADED ticks logic for frame N + 1 on a dedicated thread while the
+// calling thread (which owns the GL context and the window events) renders frame N.
+enum class Runtime_mode {
+    SERIAL,
+    THREADED
+};
+
 struct Engine_runtime_descriptor {
     int width{800};
     int height{600};
     std::string title{"RTR Engine"};
     API_type api_type{API_type::OPENGL};
     Clear_state clear_state{Clear_state::enabled()};
+    Runtime_mode runtime_mode{Runtime_mode::SERIAL};
+    // renders into an offscreen surface without opening a window, see RHI_device::create_headless_window
+    bool is_headless{false};
+    // > 0 ticks logic at this fixed rate and interpolates between the last two
+    // logic states when rendering; 0 ticks logic once per rendered frame
+    float fixed_logic_hz{0.0f};
+    // logic steps allowed per rendered frame before the remaining backlog is dropped
+    int max_logic_steps_per_frame{5};
+    // 0 leaves the frame rate uncapped
+    float target_fps{0.0f};
+    Swap_interval_mode swap_interval_mode{Swap_interval_mode::VSYNC};
+    // mesh renderers journal only what changed since the previous logic frame and the
+    // render system applies the journal to a persistent Render_scene; not available
+    // with fixed_logic_hz, whose interpolation needs complete logic states
+    bool is_incremental_render{false};
+    // writes every frame's input state and delta time to this file
+    std::string input_record_path{};
+    // feeds the frames of a recording to logic instead of live input, the runtime
+    // deactivates its window once the recording runs out
+    std::string input_replay_path{};
 };
 
 class Engine_runtime {
 private:
     float m_delta_time {0.0f};
+    Runtime_mode m_runtime_mode{Runtime_mode::SERIAL};
 
-    Swap_data m_swap_data[2];
+    Swap_data m_swap_data[4];
     int m_render_swap_data_index = 0;
     int m_logic_swap_data_index = 1;
 
+    // fixed timestep only: the two most recent finished logic states, the
+    // render swap data is interpolated from them every frame
+    int m_previous_state_index = 2;
+    int m_current_state_index = 3;
+    float m_fixed_delta_time{0.0f};
+    int m_max_logic_steps_per_frame{5};
+    float m_logic_time_accumulator{0.0f};
+    int m_finished_logic_steps{0};
+    float m_pending_alpha{1.0f};
+    Swap_interpolator m_swap_interpolator{};
+    // mouse and scroll deltas of the frames since the last logic step
+    Input_state m_pending_input_deltas{};
+
+    // logic thread mailbox, only used in Runtime_mode::THREADED
+    std::thread m_logic_thread{};
+    std::mutex m_logic_mutex{};
+    std::condition_variable m_logic_cv{};
+    bool m_is_logic_requested{false};
+    bool m_is_logic_done{true};
+    bool m_is_logic_exit{false};
+    bool m_has_logic_frame{false};
+    Input_state m_logic_input_state{};
+    float m_logic_delta_time{};
+    int m_logic_step_count{};
+    std::exception_ptr m_logic_exception{};
+
     RHI_global_resource m_rhi_global_resource{};
     
     std::shared_ptr<World> m_world{};
     std::shared_ptr<Timer> m_timer{};
+    Frame_pacer m_frame_pacer{};
 
     std::shared_ptr<Input_system> m_input_system{};
+    std::shared_ptr<Input_recorder> m_input_recorder{};
+    std::shared_ptr<Input_replayer> m_input_replayer{};
+    Input_state m_replay_input_state{};
+    // set once the replay is exhausted; later frames no longer tick
+    bool m_is_replay_finished{false};
     std::shared_ptr<Render_system> m_render_system{};
 
+    bool m_is_incremental_render{false};
+    std::vector<std::shared_ptr<World_instance>> m_world_instances{};
+
 public:
 
-    Engine_runtime(const Engine_runtime_descriptor& descriptor) {
+    Engine_runtime(const Engine_runtime_descriptor& descriptor) : 
+        m_runtime_mode(descriptor.runtime_mode),
+        m_fixed_delta_time(descriptor.fixed_logic_hz > 0.0f ? 1000.0f / descriptor.fixed_logic_hz : 0.0f),
+        m_max_logic_steps_per_frame(std::max(1, descriptor.max_logic_steps_per_frame)) {
+
+        if (descriptor.is_incremental_render) {
+            if (is_fixed_step()) {
+                throw std::runtime_error("Incremental render swap data is not supported with a fixed logic step");
+            }
+            for (auto& swap_data : m_swap_data) {
+                swap_data.is_incremental = true;
+            }
+            m_is_incremental_render = true;
+        }
 
         std::shared_ptr<RHI_device> device{};
 
@@ -51,14 +140,14 @@ public:
             throw std::runtime_error("Unsupported API type");
         }
 
-        auto window = device->create_window(
-            descriptor.width, 
-            descriptor.height, 
-            descriptor.title
-        );
+        auto window = descriptor.is_headless ? 
+            device->create_headless_window(descriptor.width, descriptor.height) :
+            device->create_window(descriptor.width, descriptor.height, descriptor.title);
 
         m_rhi_global_resource.device = device;
         m_rhi_global_resource.window = window;
+        window->set_swap_interval(descriptor.swap_interval_mode);
+        m_frame_pacer.set_target_fps(descriptor.target_fps);
         m_rhi_global_resource.renderer = device->create_renderer(descriptor.clear_state);
         m_rhi_global_resource.screen_buffer = device->create_screen_buffer(window);
         m_rhi_global_resource.memory_binder = device->create_memory_buffer_binder();
@@ -71,6 +160,12 @@ public:
         m_input_system = input_system;
         m_render_system = render_system;
 
+        if (!descriptor.input_replay_path.empty()) {
+            m_input_replayer = Input_replayer::create(descriptor.input_replay_path);
+        } else if (!descriptor.input_record_path.empty()) {
+            m_input_recorder = Input_recorder::create(descriptor.input_record_path);
+        }
+
         m_timer = std::make_shared<Timer>();
         m_timer->start();
 
@@ -84,11 +179,45 @@ public:
 
     std::shared_ptr<World>& world() { return m_world; }
 
+    // Adds a world that is ticked on the job system at the same time as world() and
+    // the other instances, then rendered with the same pipeline into an offscreen
+    // target of the given size. world() may stay null when only instances are run.
+    // Every world ticked at the same time needs its own Transform_storage, see
+    // World::create_isolated. Not available with a fixed logic step.
+    std::shared_ptr<World_instance> add_world_instance(const std::shared_ptr<World>& world, int width, int height) {
+        if (is_fixed_step()) {
+            throw std::runtime_error("World instances are not supported with a fixed logic step");
+        }
+        if (m_world && m_world->transform_storage() == world->transform_storage()) {
+            throw std::invalid_argument("Engine_runtime: world instance " + world->name() + " shares the main world's transform storage");
+        }
+        for (auto& instance : m_world_instances) {
+            if (instance->world()->transform_storage() == world->transform_storage()) {
+                throw std::invalid_argument("Engine_runtime: world instance " + world->name() + " shares the transform storage of " + instance->world()->name());
+            }
+        }
+
+        // the logic thread may still be ticking the instances of the last frame
+        wait_logic();
+
+        auto instance = World_instance::create(world, Render_system::create(m_rhi_global_resource), width, height, m_is_incremental_render);
+        m_world_instances.push_back(instance);
+        return instance;
+    }
+
+    void remove_world_instance(const std::shared_ptr<World_instance>& instance) {
+        wait_logic();
+        std::erase(m_world_instances, instance);
+    }
+
+    const std::vector<std::shared_ptr<World_instance>>& world_instances() const { return m_world_instances; }
+
     static std::shared_ptr<Engine_runtime> create(const Engine_runtime_descriptor& descriptor) {
         return std::make_shared<Engine_runtime>(descriptor);
     }
 
     virtual ~Engine_runtime() {
+        stop_logic_thread();
         Log_sys::get_instance()->log(Logging_system::Level::info, "Engine Runtime Destroyed");
     }
 
@@ -99,9 +228,12 @@ public:
     void run() {
         while (is_active()) {
             tick(get_delta_time());
+            m_frame_pacer.end_frame();
         }
     }
 
+    Frame_pacer& frame_pacer() { return m_frame_pacer; }
+
     float get_fps() const { return 1000.0f / m_delta_time; }
 
     float get_delta_time() {
@@ -114,6 +246,10 @@ public:
     Swap_data& render_swap_data() { return m_swap_data[m_render_swap_data_index]; }
     Swap_data& logic_swap_data() { return m_swap_data[m_logic_swap_data_index]; }
 
+    Runtime_mode runtime_mode() const { return m_runtime_mode; }
+    bool is_fixed_step() const { return m_fixed_delta_time > 0.0f; }
+    float fixed_delta_time() const { return m_fixed_delta_time; }
+
     void swap() {
         std::swap(m_render_swap_data_index, m_logic_swap_data_index);
     }
@@ -122,19 +258,25 @@ public:
 
         m_rhi_global_resource.window->on_frame_begin();
 
-        world()->tick(Logic_tick_context{
-            m_input_system->state(),
-            logic_swap_data(),
-            delta_time
-        });
-
-        swap();
-        logic_swap_data().clear();
-
-        render_system()->tick(Render_tick_context{
-            render_swap_data(),
-            delta_time
-        });
+        const auto* frame_input = frame_input_state(delta_time);
+        if (!frame_input) {
+            // the replay ended, nothing ticks past the last recorded frame
+            m_rhi_global_resource.window->on_frame_end();
+            return;
+        }
+        const auto& input_state = *frame_input;
+
+        if (is_fixed_step()) {
+            if (m_runtime_mode == Runtime_mode::THREADED) {
+                fixed_threaded_tick(input_state, delta_time);
+            } else {
+                fixed_serial_tick(input_state, delta_time);
+            }
+        } else if (m_runtime_mode == Runtime_mode::THREADED) {
+            threaded_tick(input_state, delta_time);
+        } else {
+            serial_tick(input_state, delta_time);
+        }
 
         m_rhi_global_resource.device->check_error();
         m_rhi_global_resource.window->on_frame_end();
@@ -147,6 +289,321 @@ public:
     const RHI_global_resource& rhi_global_resource() const {
         return m_rhi_global_resource;
     }
+
+private:
+    // Live input, or the next recorded frame when replaying; a replay also
+    // substitutes the recorded delta time so logic runs exactly as recorded.
+    // nullptr once the replay is exhausted, the window is deactivated then.
+    const Input_state* frame_input_state(float& delta_time) {
+        if (m_input_replayer) {
+            if (!m_input_replayer->next(m_replay_input_state, delta_time)) {
+                Log_sys::get_instance()->log(Logging_system::Level::info, "Input replay finished after {} frames", m_input_replayer->frame_count());
+                m_input_replayer.reset();
+                m_is_replay_finished = true;
+                m_rhi_global_resource.window->deactivate();
+            }
+            return m_is_replay_finished ? nullptr : &m_replay_input_state;
+        }
+
+        if (m_is_replay_finished) {
+            return nullptr;
+        }
+        if (m_input_recorder) {
+            m_input_recorder->record(m_input_system->state(), delta_time);
+        }
+        return &m_input_system->state();
+    }
+
+    // The instances tick as jobs while the calling thread ticks the main world and
+    // then helps with whatever instance is still running.
+    void logic_tick(const Input_state& input_state, float delta_time) {
+        auto& job_system = *Job_sys::get_instance();
+        std::vector<Job_handle> jobs{};
+        jobs.reserve(m_world_instances.size());
+        for (auto& instance : m_world_instances) {
+            jobs.push_back(job_system.schedule([instance = instance.get(), delta_time]() {
+                instance->logic_tick(delta_time);
+            }));
+        }
+
+        std::exception_ptr exception{};
+        try {
+            if (m_world) {
+                world()->tick(Logic_tick_context{
+                    input_state,
+                    logic_swap_data(),
+                    delta_time
+                });
+            }
+        } catch (...) {
+            exception = std::current_exception();
+        }
+
+        // the jobs reference the instances, all of them must finish
+        for (auto& job : jobs) {
+            try {
+                job_system.wait(job);
+            } catch (...) {
+                if (!exception) {
+                    exception = std::current_exception();
+                }
+            }
+        }
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    void render_tick(float delta_time) {
+        if (m_world) {
+            render_system()->tick(Render_tick_context{
+                render_swap_data(),
+                delta_time
+            });
+        }
+
+        for (auto& instance : m_world_instances) {
+            instance->render_system()->set_render_pipeline(render_system()->render_pipeline());
+            instance->render_tick(delta_time);
+        }
+    }
+
+    void swap_world_instances() {
+        for (auto& instance : m_world_instances) {
+            instance->swap();
+        }
+    }
+
+    void run_logic(const Input_state& input_state, float delta_time, int step_count) {
+        if (is_fixed_step()) {
+            run_fixed_steps(input_state, step_count);
+        } else {
+            logic_tick(input_state, delta_time);
+        }
+    }
+
+    // Every step ticks into the logic buffer, which then becomes the current state;
+    // the old previous state is recycled as the next logic buffer. Only the first
+    // step sees the mouse and scroll deltas, see fixed_step_input_state().
+    void run_fixed_steps(const Input_state& input_state, int step_count) {
+        if (step_count <= 0) {
+            return;
+        }
+
+        auto step_input_state = input_state;
+        for (int i = 0; i < step_count; i++) {
+            logic_tick(step_input_state, m_fixed_delta_time);
+            if (i == 0) {
+                step_input_state.mouse_dx = 0.0;
+                step_input_state.mouse_dy = 0.0;
+                step_input_state.mouse_scroll_dx = 0.0;
+                step_input_state.mouse_scroll_dy = 0.0;
+            }
+
+            auto recycled_index = m_previous_state_index;
+            m_previous_state_index = m_current_state_index;
+            m_current_state_index = m_logic_swap_data_index;
+            m_logic_swap_data_index = recycled_index;
+            logic_swap_data().clear();
+
+            m_finished_logic_steps++;
+        }
+    }
+
+    int consume_fixed_steps(float delta_time) {
+        m_logic_time_accumulator += delta_time;
+
+        auto step_count = static_cast<int>(m_logic_time_accumulator / m_fixed_delta_time);
+        if (step_count > m_max_logic_steps_per_frame) {
+            // drop the backlog instead of spiralling further behind
+            step_count = m_max_logic_steps_per_frame;
+            m_logic_time_accumulator = step_count * m_fixed_delta_time;
+        }
+
+        // the first frame always needs a logic state to render
+        if (m_finished_logic_steps == 0) {
+            step_count = std::max(step_count, 1);
+        }
+
+        m_logic_time_accumulator = std::max(0.0f, m_logic_time_accumulator - step_count * m_fixed_delta_time);
+        return step_count;
+    }
+
+    // Input_system resets the deltas every frame, but a frame runs any number of
+    // steps: they add up over frames without a step and go whole to the next step.
+    Input_state fixed_step_input_state(const Input_state& input_state, int step_count) {
+        m_pending_input_deltas.mouse_dx += input_state.mouse_dx;
+        m_pending_input_deltas.mouse_dy += input_state.mouse_dy;
+        m_pending_input_deltas.mouse_scroll_dx += input_state.mouse_scroll_dx;
+        m_pending_input_deltas.mouse_scroll_dy += input_state.mouse_scroll_dy;
+        if (step_count <= 0) {
+            return Input_state{};
+        }
+
+        auto step_input_state = input_state;
+        step_input_state.mouse_dx = m_pending_input_deltas.mouse_dx;
+        step_input_state.mouse_dy = m_pending_input_deltas.mouse_dy;
+        step_input_state.mouse_scroll_dx = m_pending_input_deltas.mouse_scroll_dx;
+        step_input_state.mouse_scroll_dy = m_pending_input_deltas.mouse_scroll_dy;
+        m_pending_input_deltas = Input_state{};
+        return step_input_state;
+    }
+
+    float fixed_step_alpha() const {
+        return std::clamp(m_logic_time_accumulator / m_fixed_delta_time, 0.0f, 1.0f);
+    }
+
+    void interpolate_render_swap_data(float alpha) {
+        m_swap_interpolator.interpolate(
+            m_swap_data[m_previous_state_index],
+            m_swap_data[m_current_state_index],
+            alpha,
+            render_swap_data()
+        );
+    }
+
+    // Handle collection only runs on frames that advanced logic, so a handle stays
+    // alive while it can still be copied out of the current logic state.
+    void fixed_serial_tick(const Input_state& input_state, float delta_time) {
+        auto step_count = consume_fixed_steps(delta_time);
+        run_fixed_steps(fixed_step_input_state(input_state, step_count), step_count);
+        interpolate_render_swap_data(fixed_step_alpha());
+
+        if (step_count > 0) {
+            collect_render_handles();
+        }
+        render_tick(delta_time);
+    }
+
+    // The logic thread owns the logic buffer and both states while it runs, so the
+    // render swap data is interpolated before the next batch of steps is kicked.
+    // The states on hand are the ones kicked last frame, so they pair with last frame's alpha.
+    void fixed_threaded_tick(const Input_state& input_state, float delta_time) {
+        wait_logic();
+
+        auto step_count = consume_fixed_steps(delta_time);
+        auto step_input_state = fixed_step_input_state(input_state, step_count);
+        if (m_finished_logic_steps == 0) {
+            run_fixed_steps(step_input_state, step_count);
+            step_count = 0;
+            m_pending_alpha = fixed_step_alpha();
+        }
+
+        interpolate_render_swap_data(m_pending_alpha);
+        m_pending_alpha = fixed_step_alpha();
+
+        if (step_count > 0) {
+            collect_render_handles();
+            kick_logic(step_input_state, delta_time, step_count);
+        }
+
+        render_tick(delta_time);
+    }
+
+    void serial_tick(const Input_state& input_state, float delta_time) {
+        logic_tick(input_state, delta_time);
+        swap();
+        logic_swap_data().clear();
+        swap_world_instances();
+        collect_render_handles();
+        render_tick(delta_time);
+    }
+
+    // The logic thread only touches logic_swap_data() and the render side only
+    // touches render_swap_data(); the two buffers are exchanged while the logic
+    // thread is parked, so the swap itself needs no further locking.
+    void threaded_tick(const Input_state& input_state, float delta_time) {
+        if (!m_has_logic_frame) {
+            // prime the pipeline so the first rendered frame has data
+            logic_tick(input_state, delta_time);
+            m_has_logic_frame = true;
+        } else {
+            wait_logic();
+        }
+
+        swap();
+        logic_swap_data().clear();
+        swap_world_instances();
+        collect_render_handles();
+        kick_logic(input_state, delta_time);
+
+        render_tick(delta_time);
+    }
+
+    // Runs while the logic side is idle, so no handle can be acquired concurrently.
+    void collect_render_handles() {
+        Material_table::get_instance()->collect();
+        Geometry_table::get_instance()->collect();
+    }
+
+    void kick_logic(const Input_state& input_state, float delta_time, int step_count = 1) {
+        if (!m_logic_thread.joinable()) {
+            m_logic_thread = std::thread([this]() { logic_thread_loop(); });
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_logic_mutex);
+            m_logic_input_state = input_state;
+            m_logic_delta_time = delta_time;
+            m_logic_step_count = step_count;
+            m_is_logic_requested = true;
+            m_is_logic_done = false;
+        }
+        m_logic_cv.notify_all();
+    }
+
+    void wait_logic() {
+        std::unique_lock<std::mutex> lock(m_logic_mutex);
+        m_logic_cv.wait(lock, [this]() { return m_is_logic_done; });
+
+        if (m_logic_exception) {
+            auto exception = m_logic_exception;
+            m_logic_exception = nullptr;
+            std::rethrow_exception(exception);
+        }
+    }
+
+    void logic_thread_loop() {
+        while (true) {
+            std::unique_lock<std::mutex> lock(m_logic_mutex);
+            m_logic_cv.wait(lock, [this]() { return m_is_logic_requested || m_is_logic_exit; });
+            if (m_is_logic_exit) {
+                return;
+            }
+
+            m_is_logic_requested = false;
+            auto input_state = m_logic_input_state;
+            auto delta_time = m_logic_delta_time;
+            auto step_count = m_logic_step_count;
+            lock.unlock();
+
+            try {
+                run_logic(input_state, delta_time, step_count);
+            } catch (...) {
+                lock.lock();
+                m_logic_exception = std::current_exception();
+                lock.unlock();
+            }
+
+            lock.lock();
+            m_is_logic_done = true;
+            lock.unlock();
+            m_logic_cv.notify_all();
+        }
+    }
+
+    void stop_logic_thread() {
+        if (!m_logic_thread.joinable()) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_logic_mutex);
+            m_is_logic_exit = true;
+        }
+        m_logic_cv.notify_all();
+        m_logic_thread.join();
+    }
     
 };
 };
\ No newline at end of file
@@ -0,0 +1,607 @@
+#pragma once
+
+#include "engine/runtime/tool/math.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace rtr {
+
+// Bounding volume hierarchy over boxes that move. Every inserted box is a leaf
+// (its proxy id stays valid until remove()), inner nodes bound their two children.
+// Leaves store a fattened box, so small moves change nothing and larger ones only
+// refit the ancestors of the leaf; the tree shape is never changed by a move.
+// Shape quality drifts as objects move away from where they were inserted, so
+// rebalance() rebuilds the inner nodes top down with a binned SAH split once the
+// SAH cost of the tree has grown too far past the cost of its last build.
+// Queries report the proxies whose exact box passes the test. They only read the tree,
+// so several can run at once, but not alongside inserts, moves or rebuilds.
+template<typename T>
+class Dynamic_bvh {
+public:
+    static constexpr uint32_t null_index = std::numeric_limits<uint32_t>::max();
+
+private:
+    struct Node {
+        // fattened for leaves
+        Bouding_box box{};
+        uint32_t parent{null_index};
+        uint32_t left{null_index};
+        // next free node while the node is free
+        uint32_t right{null_index};
+        bool is_free{false};
+
+        bool is_leaf() const { return left == null_index; }
+    };
+
+    struct Build_item {
+        uint32_t leaf{};
+        glm::vec3 centroid{};
+    };
+
+    static constexpr int bin_count = 16;
+
+    std::vector<Node> m_nodes{};
+    // by node index, meaningful for leaves only
+    std::vector<Bouding_box> m_boxes{};
+    std::vector<T> m_payloads{};
+    uint32_t m_root{null_index};
+    uint32_t m_free_list{null_index};
+    std::size_t m_leaf_count{0};
+
+    float m_fat_margin{0.1f};
+    float m_built_cost{0.0f};
+    std::size_t m_changes_since_build{0};
+
+    // scratch of builds, kept to avoid reallocating every call
+    std::vector<Build_item> m_build_items{};
+
+    // Stack of a single traversal, so the const queries can run on several threads at
+    // once. Held inline up to inline_capacity entries and spilled to the heap past that,
+    // as insertions alone do not bound the depth of the tree.
+    template<typename Entry>
+    class Traversal_stack {
+    private:
+        static constexpr std::size_t inline_capacity = 64;
+        std::array<Entry, inline_capacity> m_inline{};
+        std::vector<Entry> m_spilled{};
+        std::size_t m_size{0};
+
+    public:
+        bool empty() const { return m_size == 0; }
+
+        void push(const Entry& entry) {
+            if (m_size < inline_capacity) {
+                m_inline[m_size] = entry;
+            } else {
+                m_spilled.push_back(entry);
+            }
+            m_size++;
+        }
+
+        Entry pop() {
+            m_size--;
+            if (m_size < inline_capacity) {
+                return m_inline[m_size];
+            }
+            auto entry = m_spilled.back();
+            m_spilled.pop_back();
+            return entry;
+        }
+    };
+
+public:
+    // leaves are enlarged by fat_margin times their largest extent on every side
+    Dynamic_bvh(float fat_margin = 0.1f) : m_fat_margin(fat_margin) {}
+    ~Dynamic_bvh() = default;
+
+    std::size_t size() const { return m_leaf_count; }
+    bool empty() const { return m_leaf_count == 0; }
+
+    const T& payload(uint32_t proxy) const { return m_payloads[proxy]; }
+    T& payload(uint32_t proxy) { return m_payloads[proxy]; }
+    const Bouding_box& box(uint32_t proxy) const { return m_boxes[proxy]; }
+
+    // bounds of everything in the tree, fattened; empty for an empty tree
+    Bouding_box bounds() const {
+        return m_root == null_index ? Bouding_box{} : m_nodes[m_root].box;
+    }
+
+    uint32_t insert(const Bouding_box& box, const T& payload) {
+        auto leaf = allocate_node();
+        m_nodes[leaf].box = fatten(box);
+        m_boxes[leaf] = box;
+        m_payloads[leaf] = payload;
+        insert_leaf(leaf);
+        m_leaf_count++;
+        m_changes_since_build++;
+        return leaf;
+    }
+
+    void remove(uint32_t proxy) {
+        remove_leaf(proxy);
+        m_payloads[proxy] = T{};
+        free_node(proxy);
+        m_leaf_count--;
+        m_changes_since_build++;
+    }
+
+    // Moves a leaf to box; returns false when the fattened box still contains it and
+    // the tree was left alone, otherwise the leaf's ancestors are refit.
+    bool update(uint32_t proxy, const Bouding_box& box) {
+        m_boxes[proxy] = box;
+        auto& node = m_nodes[proxy];
+        if (contains(node.box, box)) {
+            return false;
+        }
+        node.box = fatten(box);
+        refit_ancestors(node.parent);
+        m_changes_since_build++;
+        return true;
+    }
+
+    void clear() {
+        m_nodes.clear();
+        m_boxes.clear();
+        m_payloads.clear();
+        m_root = null_index;
+        m_free_list = null_index;
+        m_leaf_count = 0;
+        m_built_cost = 0.0f;
+        m_changes_since_build = 0;
+    }
+
+    // SAH cost of the tree: summed surface area of the inner nodes relative to the root
+    float cost() const {
+        if (m_root == null_index || m_nodes[m_root].is_leaf()) {
+            return 0.0f;
+        }
+        auto root_area = surface_area(m_nodes[m_root].box);
+        if (root_area <= 0.0f) {
+            return 0.0f;
+        }
+        float area = 0.0f;
+        Traversal_stack<uint32_t> stack{};
+        stack.push(m_root);
+        while (!stack.empty()) {
+            auto index = stack.pop();
+            const auto& node = m_nodes[index];
+            if (node.is_leaf()) {
+                continue;
+            }
+            area += surface_area(node.box);
+            stack.push(node.left);
+            stack.push(node.right);
+        }
+        return area / root_area;
+    }
+
+    // Rebuilds the inner nodes from the current leaves; proxies stay valid.
+    void rebuild() {
+        m_build_items.clear();
+        m_build_items.reserve(m_leaf_count);
+        for (uint32_t index = 0; index < m_nodes.size(); index++) {
+            const auto& node = m_nodes[index];
+            if (node.is_free) {
+                continue;
+            }
+            if (node.is_leaf()) {
+                m_build_items.push_back(Build_item{index, node.box.center()});
+            } else {
+                free_node(index);
+            }
+        }
+
+        m_root = m_build_items.empty() ? null_index : build(0, static_cast<uint32_t>(m_build_items.size()));
+        if (m_root != null_index) {
+            m_nodes[m_root].parent = null_index;
+        }
+        m_built_cost = cost();
+        m_changes_since_build = 0;
+    }
+
+    // rebuilds when the cost grew past max_cost_growth times the cost after the last build
+    bool rebalance(float max_cost_growth = 1.5f) {
+        if (m_changes_since_build == 0) {
+            return false;
+        }
+        if (cost() <= m_built_cost * max_cost_growth) {
+            return false;
+        }
+        rebuild();
+        return true;
+    }
+
+    // func(proxy) for every leaf overlapping box
+    template<typename Func>
+    void query(const Bouding_box& box, Func&& func) const {
+        traverse(
+            [&](const Bouding_box& node_box) { return node_box.overlap(box); },
+            [&](uint32_t proxy) {
+                if (m_boxes[proxy].overlap(box)) {
+                    func(proxy);
+                }
+            }
+        );
+    }
+
+    // func(proxy) for every leaf overlapping sphere
+    template<typename Func>
+    void query(const Sphere& sphere, Func&& func) const {
+        auto radius_squared = sphere.radius * sphere.radius;
+        traverse(
+            [&](const Bouding_box& node_box) { return distance_squared(node_box, sphere.center) <= radius_squared; },
+            [&](uint32_t proxy) {
+                if (distance_squared(m_boxes[proxy], sphere.center) <= radius_squared) {
+                    func(proxy);
+                }
+            }
+        );
+    }
+
+    // func(proxy) for every leaf intersecting frustum, as conservative as
+    // Frustum::intersects(Bouding_box). Subtrees outside a plane are skipped whole,
+    // planes a subtree is inside of are not tested again below it.
+    template<typename Func>
+    void query(const Frustum& frustum, Func&& func) const {
+        if (m_root == null_index) {
+            return;
+        }
+        constexpr uint8_t all_planes = 0x3f;
+        Traversal_stack<std::pair<uint32_t, uint8_t>> stack{};
+        stack.push({m_root, all_planes});
+        while (!stack.empty()) {
+            auto [index, planes] = stack.pop();
+            const auto& node = m_nodes[index];
+
+            const auto& box = node.is_leaf() ? m_boxes[index] : node.box;
+            if (planes != 0 && !classify(frustum, box, planes)) {
+                continue;
+            }
+            if (node.is_leaf()) {
+                func(index);
+                continue;
+            }
+            stack.push({node.right, planes});
+            stack.push({node.left, planes});
+        }
+    }
+
+    // Visits the leaves whose box the ray enters before max_distance, nearer subtrees
+    // first: func(proxy, entry distance) returns the distance to keep searching to,
+    // e.g. a closer hit found inside the leaf to stop at the nearest one. Distances
+    // are in multiples of ray.direction.
+    template<typename Func>
+    void raycast(const Ray& ray, float max_distance, Func&& func) const {
+        if (m_root == null_index) {
+            return;
+        }
+        auto inverse_direction = glm::vec3(1.0f) / ray.direction;
+        float distance{};
+        if (!intersect(m_nodes[m_root].box, ray.origin, inverse_direction, max_distance, distance)) {
+            return;
+        }
+
+        Traversal_stack<std::pair<uint32_t, float>> stack{};
+        stack.push({m_root, distance});
+        while (!stack.empty()) {
+            auto [index, entry] = stack.pop();
+            if (entry > max_distance) {
+                continue;
+            }
+            const auto& node = m_nodes[index];
+
+            if (node.is_leaf()) {
+                if (intersect(m_boxes[index], ray.origin, inverse_direction, max_distance, distance)) {
+                    max_distance = std::min(max_distance, static_cast<float>(func(index, distance)));
+                }
+                continue;
+            }
+
+            float left_distance{}, right_distance{};
+            bool is_left_hit = intersect(m_nodes[node.left].box, ray.origin, inverse_direction, max_distance, left_distance);
+            bool is_right_hit = intersect(m_nodes[node.right].box, ray.origin, inverse_direction, max_distance, right_distance);
+            if (is_left_hit && is_right_hit) {
+                // the nearer child is popped first
+                if (left_distance <= right_distance) {
+                    stack.push({node.right, right_distance});
+                    stack.push({node.left, left_distance});
+                } else {
+                    stack.push({node.left, left_distance});
+                    stack.push({node.right, right_distance});
+                }
+            } else if (is_left_hit) {
+                stack.push({node.left, left_distance});
+            } else if (is_right_hit) {
+                stack.push({node.right, right_distance});
+            }
+        }
+    }
+
+    // slab test; distance = where the ray enters the box, 0 when it starts inside
+    static bool intersect(
+        const Bouding_box& box,
+        const glm::vec3& origin,
+        const glm::vec3& inverse_direction,
+        float max_distance,
+        float& distance
+    ) {
+        auto t0 = (box.min - origin) * inverse_direction;
+        auto t1 = (box.max - origin) * inverse_direction;
+        auto near = glm::min(t0, t1);
+        auto far = glm::max(t0, t1);
+        // fmax/fmin drop the NaN of a ray running inside a slab plane
+        auto t_near = std::fmax(std::fmax(std::fmax(near.x, near.y), near.z), 0.0f);
+        auto t_far = std::fmin(std::fmin(std::fmin(far.x, far.y), far.z), max_distance);
+        distance = t_near;
+        return t_near <= t_far;
+    }
+
+private:
+    uint32_t allocate_node() {
+        if (m_free_list != null_index) {
+            auto index = m_free_list;
+            m_free_list = m_nodes[index].right;
+            m_nodes[index] = Node{};
+            return index;
+        }
+        m_nodes.emplace_back();
+        m_boxes.emplace_back();
+        m_payloads.emplace_back();
+        return static_cast<uint32_t>(m_nodes.size() - 1);
+    }
+
+    void free_node(uint32_t index) {
+        auto& node = m_nodes[index];
+        node.is_free = true;
+        node.parent = null_index;
+        node.right = m_free_list;
+        m_free_list = index;
+    }
+
+    Bouding_box fatten(const Bouding_box& box) const {
+        auto extent = box.extent();
+        auto margin = glm::vec3(m_fat_margin * std::max({extent.x, extent.y, extent.z}));
+        return Bouding_box{box.min - margin, box.max + margin};
+    }
+
+    static bool contains(const Bouding_box& outer, const Bouding_box& inner) {
+        return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+               outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+    }
+
+    static float surface_area(const Bouding_box& box) {
+        auto extent = box.extent();
+        return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+
+    static float distance_squared(const Bouding_box& box, const glm::vec3& point) {
+        auto closest = glm::clamp(point, box.min, box.max);
+        auto offset = point - closest;
+        return glm::dot(offset, offset);
+    }
+
+    // false when box is outside one of the planes; clears the planes it is inside of
+    static bool classify(const Frustum& frustum, const Bouding_box& box, uint8_t& planes) {
+        auto center = box.center();
+        auto half_extent = box.extent() * 0.5f;
+        for (int p = 0; p < 6; p++) {
+            if (!(planes & (1 << p))) {
+                continue;
+            }
+            const auto& plane = frustum.planes[p];
+            auto normal = glm::vec3(plane);
+            auto distance = glm::dot(normal, center) + plane.w;
+            auto radius = glm::dot(glm::abs(normal), half_extent);
+            if (distance < -radius) {
+                return false;
+            }
+            if (distance >= radius) {
+                planes &= ~(1 << p);
+            }
+        }
+        return true;
+    }
+
+    // Walks down from the root to the sibling whose enlargement costs the least,
+    // the greedy surface area descent of Box2D's dynamic tree.
+    void insert_leaf(uint32_t leaf) {
+        if (m_root == null_index) {
+            m_root = leaf;
+            m_nodes[leaf].parent = null_index;
+            return;
+        }
+
+        const auto leaf_box = m_nodes[leaf].box;
+        auto sibling = m_root;
+        while (!m_nodes[sibling].is_leaf()) {
+            const auto& node = m_nodes[sibling];
+            auto area = surface_area(node.box);
+            auto combined_area = surface_area(node.box + leaf_box);
+
+            // pairing with this node, or pushing the leaf further down
+            auto cost = 2.0f * combined_area;
+            auto inheritance_cost = 2.0f * (combined_area - area);
+
+            auto child_cost = [&](uint32_t child) {
+                const auto& child_box = m_nodes[child].box;
+                auto enlarged_area = surface_area(child_box + leaf_box);
+                if (m_nodes[child].is_leaf()) {
+                    return enlarged_area + inheritance_cost;
+                }
+                return enlarged_area - surface_area(child_box) + inheritance_cost;
+            };
+            auto left_cost = child_cost(node.left);
+            auto right_cost = child_cost(node.right);
+
+            if (cost < left_cost && cost < right_cost) {
+                break;
+            }
+            sibling = left_cost < right_cost ? node.left : node.right;
+        }
+
+        auto old_parent = m_nodes[sibling].parent;
+        auto new_parent = allocate_node();
+        m_nodes[new_parent].parent = old_parent;
+        m_nodes[new_parent].box = m_nodes[sibling].box + leaf_box;
+        m_nodes[new_parent].left = sibling;
+        m_nodes[new_parent].right = leaf;
+        m_nodes[sibling].parent = new_parent;
+        m_nodes[leaf].parent = new_parent;
+
+        if (old_parent == null_index) {
+            m_root = new_parent;
+        } else {
+            auto& parent = m_nodes[old_parent];
+            (parent.left == sibling ? parent.left : parent.right) = new_parent;
+            refit_ancestors(old_parent);
+        }
+    }
+
+    void remove_leaf(uint32_t leaf) {
+        if (leaf == m_root) {
+            m_root = null_index;
+            return;
+        }
+
+        auto parent = m_nodes[leaf].parent;
+        auto grand_parent = m_nodes[parent].parent;
+        auto sibling = m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+
+        if (grand_parent == null_index) {
+            m_root = sibling;
+            m_nodes[sibling].parent = null_index;
+        } else {
+            auto& node = m_nodes[grand_parent];
+            (node.left == parent ? node.left : node.right) = sibling;
+            m_nodes[sibling].parent = grand_parent;
+            refit_ancestors(grand_parent);
+        }
+        free_node(parent);
+    }
+
+    // stops at the first ancestor whose box is already exact
+    void refit_ancestors(uint32_t index) {
+        while (index != null_index) {
+            auto& node = m_nodes[index];
+            auto box = m_nodes[node.left].box + m_nodes[node.right].box;
+            if (box.min == node.box.min && box.max == node.box.max) {
+                break;
+            }
+            node.box = box;
+            index = node.parent;
+        }
+    }
+
+    template<typename Test, typename Visit>
+    void traverse(Test&& test, Visit&& visit) const {
+        if (m_root == null_index) {
+            return;
+        }
+        Traversal_stack<uint32_t> stack{};
+        stack.push(m_root);
+        while (!stack.empty()) {
+            auto index = stack.pop();
+            const auto& node = m_nodes[index];
+            if (node.is_leaf()) {
+                visit(index);
+                continue;
+            }
+            if (!test(node.box)) {
+                continue;
+            }
+            stack.push(node.right);
+            stack.push(node.left);
+        }
+    }
+
+    // Inner node over m_build_items[begin, end): binned SAH on the centroids along the
+    // longest centroid axis, a median split when the centroids coincide.
+    uint32_t build(uint32_t begin, uint32_t end) {
+        if (end - begin == 1) {
+            return m_build_items[begin].leaf;
+        }
+
+        Bouding_box centroid_bounds{};
+        for (auto i = begin; i < end; i++) {
+            centroid_bounds += m_build_items[i].centroid;
+        }
+        auto extent = centroid_bounds.extent();
+        int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+        auto middle = begin + (end - begin) / 2;
+        if (extent[axis] > 0.0f) {
+            std::array<Bouding_box, bin_count> bin_boxes{};
+            std::array<uint32_t, bin_count> bin_counts{};
+            auto scale = bin_count / extent[axis];
+            auto bin_of = [&](const Build_item& item) {
+                auto bin = static_cast<int>((item.centroid[axis] - centroid_bounds.min[axis]) * scale);
+                return std::clamp(bin, 0, bin_count - 1);
+            };
+            for (auto i = begin; i < end; i++) {
+                auto bin = bin_of(m_build_items[i]);
+                bin_boxes[bin] += m_nodes[m_build_items[i].leaf].box;
+                bin_counts[bin]++;
+            }
+
+            // cost of splitting after every bin: left sweep then right sweep
+            std::array<float, bin_count - 1> left_costs{};
+            Bouding_box left_box{};
+            uint32_t left_count = 0;
+            for (int bin = 0; bin < bin_count - 1; bin++) {
+                left_box += bin_boxes[bin];
+                left_count += bin_counts[bin];
+                left_costs[bin] = left_count ? surface_area(left_box) * left_count : 0.0f;
+            }
+            Bouding_box right_box{};
+            uint32_t right_count = 0;
+            float best_cost = std::numeric_limits<float>::max();
+            int best_bin = -1;
+            for (int bin = bin_count - 1; bin > 0; bin--) {
+                right_box += bin_boxes[bin];
+                right_count += bin_counts[bin];
+                auto split_cost = left_costs[bin - 1] + (right_count ? surface_area(right_box) * right_count : 0.0f);
+                if (right_count && right_count != end - begin && split_cost < best_cost) {
+                    best_cost = split_cost;
+                    best_bin = bin;
+                }
+            }
+
+            if (best_bin > 0) {
+                auto split = std::partition(
+                    m_build_items.begin() + begin,
+                    m_build_items.begin() + end,
+                    [&](const Build_item& item) { return bin_of(item) < best_bin; }
+                );
+                middle = static_cast<uint32_t>(split - m_build_items.begin());
+            }
+        }
+        if (middle == begin || middle == end) {
+            middle = begin + (end - begin) / 2;
+            std::nth_element(
+                m_build_items.begin() + begin,
+                m_build_items.begin() + middle,
+                m_build_items.begin() + end,
+                [&](const Build_item& lhs, const Build_item& rhs) { return lhs.centroid[axis] < rhs.centroid[axis]; }
+            );
+        }
+
+        auto left = build(begin, middle);
+        auto right = build(middle, end);
+        auto index = allocate_node();
+        auto& node = m_nodes[index];
+        node.left = left;
+        node.right = right;
+        node.box = m_nodes[left].box + m_nodes[right].box;
+        m_nodes[left].parent = index;
+        m_nodes[right].parent = index;
+        return index;
+    }
+};
+
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "engine/runtime/tool/timer.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+namespace rtr {
+
+struct Frame_pacing_stats {
+    double mean_frame_ms{};
+    double min_frame_ms{};
+    double max_frame_ms{};
+    // standard deviation of the frame interval over the sample window
+    double jitter_ms{};
+    // frames that took longer than 1.5x the target interval, since the last reset
+    uint64_t late_frames{};
+    uint64_t frame_count{};
+};
+
+// Caps the frame rate by waiting at the end of every frame until the next frame
+// deadline. Most of the wait is an OS sleep; the last spin_threshold_ms are spent
+// yielding, because sleep wakeups are only accurate to about a millisecond.
+class Frame_pacer {
+public:
+    static constexpr std::size_t sample_count = 240;
+
+private:
+    Timer m_timer{};
+    double m_target_frame_ms{0.0};
+    double m_spin_threshold_ms{1.5};
+
+    double m_next_deadline_ms{0.0};
+    double m_last_frame_end_ms{0.0};
+    bool m_has_frame{false};
+
+    std::array<double, sample_count> m_samples{};
+    std::size_t m_sample_index{0};
+    std::size_t m_sample_size{0};
+    uint64_t m_late_frames{0};
+    uint64_t m_frame_count{0};
+
+public:
+    Frame_pacer(float target_fps = 0.0f) {
+        set_target_fps(target_fps);
+        m_timer.start();
+    }
+
+    // 0 disables the cap, frames are still measured
+    void set_target_fps(float target_fps) {
+        m_target_frame_ms = target_fps > 0.0f ? 1000.0 / target_fps : 0.0;
+        m_has_frame = false;
+    }
+
+    float target_fps() const {
+        return m_target_frame_ms > 0.0 ? static_cast<float>(1000.0 / m_target_frame_ms) : 0.0f;
+    }
+
+    void set_spin_threshold_ms(double spin_threshold_ms) { m_spin_threshold_ms = std::max(0.0, spin_threshold_ms); }
+    double spin_threshold_ms() const { return m_spin_threshold_ms; }
+
+    // Call once at the end of every frame.
+    void end_frame() {
+        auto now = m_timer.elapsed_ms<double>();
+
+        if (m_target_frame_ms > 0.0) {
+            if (!m_has_frame) {
+                m_next_deadline_ms = now + m_target_frame_ms;
+            } else {
+                wait_until(m_next_deadline_ms);
+                now = m_timer.elapsed_ms<double>();
+                m_next_deadline_ms += m_target_frame_ms;
+                // after a long stall start over instead of rushing frames to catch up
+                if (m_next_deadline_ms < now) {
+                    m_next_deadline_ms = now + m_target_frame_ms;
+                }
+            }
+        }
+
+        if (m_has_frame) {
+            record(now - m_last_frame_end_ms);
+        }
+        m_last_frame_end_ms = now;
+        m_has_frame = true;
+    }
+
+    Frame_pacing_stats stats() const {
+        Frame_pacing_stats result{};
+        result.late_frames = m_late_frames;
+        result.frame_count = m_frame_count;
+        if (m_sample_size == 0) {
+            return result;
+        }
+
+        double sum = 0.0;
+        result.min_frame_ms = m_samples[0];
+        result.max_frame_ms = m_samples[0];
+        for (std::size_t i = 0; i < m_sample_size; i++) {
+            sum += m_samples[i];
+            result.min_frame_ms = std::min(result.min_frame_ms, m_samples[i]);
+            result.max_frame_ms = std::max(result.max_frame_ms, m_samples[i]);
+        }
+        result.mean_frame_ms = sum / m_sample_size;
+
+        double variance = 0.0;
+        for (std::size_t i = 0; i < m_sample_size; i++) {
+            auto diff = m_samples[i] - result.mean_frame_ms;
+            variance += diff * diff;
+        }
+        result.jitter_ms = std::sqrt(variance / m_sample_size);
+        return result;
+    }
+
+    void reset_stats() {
+        m_sample_index = 0;
+        m_sample_size = 0;
+        m_late_frames = 0;
+        m_frame_count = 0;
+    }
+
+private:
+    void wait_until(double deadline_ms) {
+        auto remaining_ms = deadline_ms - m_timer.elapsed_ms<double>();
+        if (remaining_ms > m_spin_threshold_ms) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(remaining_ms - m_spin_threshold_ms));
+        }
+        while (m_timer.elapsed_ms<double>() < deadline_ms) {
+            std::this_thread::yield();
+        }
+    }
+
+    void record(double frame_ms) {
+        m_samples[m_sample_index] = frame_ms;
+        m_sample_index = (m_sample_index + 1) % sample_count;
+        m_sample_size = std::min(m_sample_size + 1, sample_count);
+        m_frame_count++;
+
+        if (m_target_frame_ms > 0.0 && frame_ms > m_target_frame_ms * 1.5) {
+            m_late_frames++;
+        }
+    }
+
+};
+
+}
@@ -0,0 +1,424 @@
+#pragma once
+
+#include "engine/runtime/tool/singleton.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rtr {
+
+class Job_system;
+
+class Job {
+    friend class Job_system;
+
+private:
+    std::function<void()> m_task{};
+    // starts at 1 so the job cannot be enqueued while its dependencies are still being registered
+    std::atomic<int> m_pending_dependencies{1};
+    std::atomic<bool> m_is_finished{false};
+    std::mutex m_mutex{};
+    std::vector<std::shared_ptr<Job>> m_continuations{};
+    std::exception_ptr m_exception{};
+
+public:
+    Job(std::function<void()> task) : m_task(std::move(task)) {}
+    ~Job() = default;
+
+    bool is_finished() const { return m_is_finished.load(std::memory_order_acquire); }
+};
+
+using Job_handle = std::shared_ptr<Job>;
+
+struct Job_worker_stats {
+    uint64_t executed_jobs{};
+    uint64_t stolen_jobs{};
+    double busy_ms{};
+    double elapsed_ms{};
+
+    float utilization() const {
+        if (elapsed_ms <= 0.0) {
+            return 0.0f;
+        }
+        return static_cast<float>(std::min(1.0, busy_ms / elapsed_ms));
+    }
+};
+
+// Work-stealing scheduler. Every worker owns a deque: the owner pushes and pops
+// at the back (LIFO, cache friendly), idle workers steal from the front (FIFO).
+// Threads that are not workers submit into an extra injection queue and help
+// execute jobs while they wait, so a Job_system with zero workers still makes progress.
+class Job_system {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Work_queue {
+        std::mutex mutex{};
+        std::deque<Job_handle> jobs{};
+
+        void push(const Job_handle& job) {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(job);
+        }
+
+        Job_handle pop() {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (jobs.empty()) {
+                return nullptr;
+            }
+            auto job = std::move(jobs.back());
+            jobs.pop_back();
+            return job;
+        }
+
+        Job_handle steal() {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (jobs.empty()) {
+                return nullptr;
+            }
+            auto job = std::move(jobs.front());
+            jobs.pop_front();
+            return job;
+        }
+    };
+
+    struct Worker_counters {
+        std::atomic<uint64_t> executed_jobs{0};
+        std::atomic<uint64_t> stolen_jobs{0};
+        std::atomic<uint64_t> busy_ns{0};
+    };
+
+    struct Thread_binding {
+        const Job_system* owner{nullptr};
+        std::size_t index{0};
+    };
+
+    // Adds the outermost stretch of work on the calling thread to its busy time, so
+    // jobs run while waiting inside a job or a parallel_for chunk count only once.
+    class Busy_scope {
+    private:
+        Worker_counters& m_counters;
+        Clock::time_point m_start{};
+        bool m_is_outermost{};
+
+    public:
+        Busy_scope(Worker_counters& counters) : m_counters(counters) {
+            m_is_outermost = busy_depth()++ == 0;
+            if (m_is_outermost) {
+                m_start = Clock::now();
+            }
+        }
+
+        ~Busy_scope() {
+            busy_depth()--;
+            if (m_is_outermost) {
+                m_counters.busy_ns.fetch_add(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count(),
+                    std::memory_order_relaxed
+                );
+            }
+        }
+
+        Busy_scope(const Busy_scope&) = delete;
+        Busy_scope& operator=(const Busy_scope&) = delete;
+    };
+
+    std::size_t m_worker_count{};
+    // m_queues[m_worker_count] is the injection queue used by non-worker threads
+    std::vector<std::unique_ptr<Work_queue>> m_queues{};
+    // m_counters[m_worker_count] accumulates work done by helping non-worker threads
+    std::vector<std::unique_ptr<Worker_counters>> m_counters{};
+    std::vector<std::thread> m_workers{};
+
+    std::atomic<std::size_t> m_queued_jobs{0};
+    std::atomic<std::size_t> m_sleeping_workers{0};
+    std::atomic<bool> m_is_exit{false};
+    std::mutex m_sleep_mutex{};
+    std::condition_variable m_sleep_cv{};
+
+    Clock::time_point m_stats_start{Clock::now()};
+
+public:
+    Job_system() : Job_system(default_worker_count()) {}
+
+    Job_system(std::size_t worker_count) : m_worker_count(worker_count) {
+        for (std::size_t i = 0; i <= m_worker_count; i++) {
+            m_queues.push_back(std::make_unique<Work_queue>());
+            m_counters.push_back(std::make_unique<Worker_counters>());
+        }
+
+        for (std::size_t i = 0; i < m_worker_count; i++) {
+            m_workers.emplace_back([this, i]() { worker_loop(i); });
+        }
+    }
+
+    ~Job_system() {
+        m_is_exit.store(true);
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        }
+        m_sleep_cv.notify_all();
+
+        for (auto& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    Job_system(const Job_system&) = delete;
+    Job_system& operator=(const Job_system&) = delete;
+
+    static std::size_t default_worker_count() {
+        auto hardware_threads = std::thread::hardware_concurrency();
+        return hardware_threads > 1 ? hardware_threads - 1 : 0;
+    }
+
+    static std::shared_ptr<Job_system> create(std::size_t worker_count = default_worker_count()) {
+        return std::make_shared<Job_system>(worker_count);
+    }
+
+    std::size_t worker_count() const { return m_worker_count; }
+    // workers plus the thread that waits and helps
+    std::size_t concurrency() const { return m_worker_count + 1; }
+
+    bool is_worker_thread() const {
+        return thread_binding().owner == this && thread_binding().index < m_worker_count;
+    }
+
+    // Schedules a job that starts once every job in dependencies has finished.
+    Job_handle schedule(
+        std::function<void()> task,
+        const std::vector<Job_handle>& dependencies = {}
+    ) {
+        auto job = std::make_shared<Job>(std::move(task));
+
+        for (const auto& dependency : dependencies) {
+            if (!dependency) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(dependency->m_mutex);
+            if (!dependency->m_is_finished.load(std::memory_order_acquire)) {
+                job->m_pending_dependencies.fetch_add(1, std::memory_order_relaxed);
+                dependency->m_continuations.push_back(job);
+            }
+        }
+
+        if (job->m_pending_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            enqueue(job);
+        }
+        return job;
+    }
+
+    // Blocks until job has finished, executing other queued jobs in the meantime.
+    void wait(const Job_handle& job) {
+        if (!job) {
+            return;
+        }
+
+        auto index = current_index();
+        while (!job->is_finished()) {
+            if (auto next = find_job(index)) {
+                execute(next, index);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+        if (job->m_exception) {
+            std::rethrow_exception(job->m_exception);
+        }
+    }
+
+    void wait(const std::vector<Job_handle>& jobs) {
+        for (const auto& job : jobs) {
+            wait(job);
+        }
+    }
+
+    // Splits [0, count) into chunks of at most grain_size elements and calls
+    // fn(begin, end) for each chunk across the workers. Returns once every chunk is done.
+    template<typename Fn>
+    void parallel_for(std::size_t count, std::size_t grain_size, Fn&& fn) {
+        if (count == 0) {
+            return;
+        }
+
+        grain_size = std::max<std::size_t>(1, grain_size);
+        if (count <= grain_size || m_worker_count == 0) {
+            Busy_scope busy{*m_counters[current_index()]};
+            fn(std::size_t{0}, count);
+            return;
+        }
+
+        std::vector<Job_handle> jobs{};
+        jobs.reserve((count + grain_size - 1) / grain_size);
+        for (std::size_t begin = grain_size; begin < count; begin += grain_size) {
+            auto end = std::min(count, begin + grain_size);
+            jobs.push_back(schedule([&fn, begin, end]() { fn(begin, end); }));
+        }
+
+        // the calling thread takes the first chunk itself; every chunk must
+        // finish before returning because the jobs reference fn
+        std::exception_ptr exception{};
+        try {
+            Busy_scope busy{*m_counters[current_index()]};
+            fn(std::size_t{0}, std::min(count, grain_size));
+        } catch (...) {
+            exception = std::current_exception();
+        }
+
+        for (const auto& job : jobs) {
+            try {
+                wait(job);
+            } catch (...) {
+                if (!exception) {
+                    exception = std::current_exception();
+                }
+            }
+        }
+
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    // Picks a grain size that gives every thread a few chunks to balance uneven work.
+    std::size_t suggest_grain_size(std::size_t count, std::size_t chunks_per_thread = 4) const {
+        auto chunk_count = std::max<std::size_t>(1, concurrency() * chunks_per_thread);
+        return std::max<std::size_t>(1, (count + chunk_count - 1) / chunk_count);
+    }
+
+    // One entry per worker followed by one entry for non-worker threads, which covers
+    // the chunks parallel_for runs on the calling thread and the jobs they help with.
+    std::vector<Job_worker_stats> stats() const {
+        auto elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - m_stats_start).count();
+
+        std::vector<Job_worker_stats> result{};
+        for (const auto& counters : m_counters) {
+            result.push_back(Job_worker_stats{
+                .executed_jobs = counters->executed_jobs.load(std::memory_order_relaxed),
+                .stolen_jobs = counters->stolen_jobs.load(std::memory_order_relaxed),
+                .busy_ms = counters->busy_ns.load(std::memory_order_relaxed) / 1.0e6,
+                .elapsed_ms = elapsed_ms
+            });
+        }
+        return result;
+    }
+
+    void reset_stats() {
+        for (auto& counters : m_counters) {
+            counters->executed_jobs.store(0, std::memory_order_relaxed);
+            counters->stolen_jobs.store(0, std::memory_order_relaxed);
+            counters->busy_ns.store(0, std::memory_order_relaxed);
+        }
+        m_stats_start = Clock::now();
+    }
+
+private:
+    static Thread_binding& thread_binding() {
+        static thread_local Thread_binding binding{};
+        return binding;
+    }
+
+    static int& busy_depth() {
+        static thread_local int depth = 0;
+        return depth;
+    }
+
+    std::size_t current_index() const {
+        if (thread_binding().owner == this) {
+            return thread_binding().index;
+        }
+        return m_worker_count;
+    }
+
+    void enqueue(const Job_handle& job) {
+        m_queues[current_index()]->push(job);
+        m_queued_jobs.fetch_add(1);
+
+        if (m_sleeping_workers.load() > 0) {
+            {
+                std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            }
+            m_sleep_cv.notify_one();
+        }
+    }
+
+    Job_handle find_job(std::size_t index) {
+        if (auto job = m_queues[index]->pop()) {
+            m_queued_jobs.fetch_sub(1);
+            return job;
+        }
+
+        auto queue_count = m_queues.size();
+        for (std::size_t offset = 1; offset < queue_count; offset++) {
+            auto victim = (index + offset) % queue_count;
+            if (auto job = m_queues[victim]->steal()) {
+                m_queued_jobs.fetch_sub(1);
+                m_counters[index]->stolen_jobs.fetch_add(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void execute(const Job_handle& job, std::size_t index) {
+        auto& counters = *m_counters[index];
+        {
+            Busy_scope busy{counters};
+            try {
+                job->m_task();
+            } catch (...) {
+                job->m_exception = std::current_exception();
+            }
+            job->m_task = nullptr;
+        }
+        counters.executed_jobs.fetch_add(1, std::memory_order_relaxed);
+
+        std::vector<Job_handle> continuations{};
+        {
+            std::lock_guard<std::mutex> lock(job->m_mutex);
+            job->m_is_finished.store(true, std::memory_order_release);
+            continuations.swap(job->m_continuations);
+        }
+
+        for (auto& continuation : continuations) {
+            if (continuation->m_pending_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                enqueue(continuation);
+            }
+        }
+    }
+
+    void worker_loop(std::size_t index) {
+        thread_binding() = Thread_binding{this, index};
+
+        while (!m_is_exit.load()) {
+            if (auto job = find_job(index)) {
+                execute(job, index);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleep_mutex);
+            m_sleeping_workers.fetch_add(1);
+            m_sleep_cv.wait(lock, [this]() {
+                return m_is_exit.load() || m_queued_jobs.load() > 0;
+            });
+            m_sleeping_workers.fetch_sub(1);
+        }
+    }
+
+};
+
+using Job_sys = Singleton<Job_system>;
+
+}
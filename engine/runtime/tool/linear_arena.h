@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace rtr {
+
+// Bump allocator for data that lives exactly one frame. Individual deallocation is
+// a no-op, reset() rewinds everything at once. When a frame overflows the current
+// blocks a new block is chained, and the next reset() merges them into a single
+// block, so after a few frames the arena stops touching the heap entirely.
+class Linear_arena {
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data{};
+        std::size_t size{};
+    };
+
+    std::vector<Block> m_blocks{};
+    std::size_t m_block_index{0};
+    std::size_t m_offset{0};
+    std::size_t m_min_block_size{};
+
+    std::size_t m_used{0};
+    std::size_t m_peak_used{0};
+
+public:
+    Linear_arena(std::size_t min_block_size = 64 * 1024) : m_min_block_size(min_block_size) {}
+    ~Linear_arena() = default;
+
+    Linear_arena(const Linear_arena&) = delete;
+    Linear_arena& operator=(const Linear_arena&) = delete;
+
+    static std::unique_ptr<Linear_arena> create(std::size_t min_block_size = 64 * 1024) {
+        return std::make_unique<Linear_arena>(min_block_size);
+    }
+
+    void* allocate(std::size_t size, std::size_t alignment) {
+        while (true) {
+            if (m_block_index < m_blocks.size()) {
+                auto& block = m_blocks[m_block_index];
+                auto base = reinterpret_cast<std::uintptr_t>(block.data.get());
+                auto aligned = (base + m_offset + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+                auto end = aligned - base + size;
+
+                if (end <= block.size) {
+                    m_used += end - m_offset;
+                    m_peak_used = std::max(m_peak_used, m_used);
+                    m_offset = end;
+                    return reinterpret_cast<void*>(aligned);
+                }
+
+                m_block_index++;
+                m_offset = 0;
+                continue;
+            }
+
+            auto block_size = std::max(m_min_block_size, size + alignment);
+            m_blocks.push_back(Block{std::make_unique<std::byte[]>(block_size), block_size});
+        }
+    }
+
+    // Every pointer handed out since the last reset becomes invalid.
+    void reset() {
+        if (m_blocks.size() > 1) {
+            std::size_t total_size = 0;
+            for (const auto& block : m_blocks) {
+                total_size += block.size;
+            }
+            m_blocks.clear();
+            m_blocks.push_back(Block{std::make_unique<std::byte[]>(total_size), total_size});
+        }
+
+        m_block_index = 0;
+        m_offset = 0;
+        m_used = 0;
+    }
+
+    std::size_t used() const { return m_used; }
+    std::size_t peak_used() const { return m_peak_used; }
+
+    std::size_t capacity() const {
+        std::size_t total_size = 0;
+        for (const auto& block : m_blocks) {
+            total_size += block.size;
+        }
+        return total_size;
+    }
+
+};
+
+// Standard allocator adapter over a Linear_arena. A default constructed allocator
+// (no arena) falls back to the global heap so containers stay usable on their own.
+template<typename T>
+class Arena_allocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+private:
+    Linear_arena* m_arena{nullptr};
+
+public:
+    Arena_allocator() noexcept = default;
+    Arena_allocator(Linear_arena* arena) noexcept : m_arena(arena) {}
+
+    template<typename U>
+    Arena_allocator(const Arena_allocator<U>& other) noexcept : m_arena(other.arena()) {}
+
+    T* allocate(std::size_t count) {
+        if (!m_arena) {
+            return std::allocator<T>{}.allocate(count);
+        }
+        return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t count) noexcept {
+        if (!m_arena) {
+            std::allocator<T>{}.deallocate(pointer, count);
+        }
+    }
+
+    Linear_arena* arena() const noexcept { return m_arena; }
+
+    template<typename U>
+    bool operator==(const Arena_allocator<U>& other) const noexcept {
+        return m_arena == other.arena();
+    }
+
+};
+
+template<typename T>
+using Arena_vector = std::vector<T, Arena_allocator<T>>;
+
+}
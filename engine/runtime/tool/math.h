@@ -13,9 +13,23 @@
 #include "glm/fwd.hpp"
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <vector>
 
+#if defined(__AVX2__) && defined(__FMA__)
+#define RTR_SIMD_AVX2 1
+#endif
+
+#if defined(__SSE4_1__)
+#define RTR_SIMD_SSE4 1
+#endif
+
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+#include <immintrin.h>
+#endif
+
 namespace rtr {
 
 constexpr float PI = 3.14159265358979323846f;
@@ -38,13 +52,14 @@ struct Bouding_box {
     glm::vec3 min{};
     glm::vec3 max{};
 
+    // empty: adding any point makes it that point
     Bouding_box() : 
     min(glm::vec3(std::numeric_limits<float>::max())), 
-    max(glm::vec3(std::numeric_limits<float>::min())) {}
+    max(glm::vec3(std::numeric_limits<float>::lowest())) {}
 
     Bouding_box(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {}
 
-    Bouding_box(const std::vector<glm::vec3>& points) {
+    Bouding_box(const std::vector<glm::vec3>& points) : Bouding_box() {
         for (const auto& point : points) {
             min = glm::min(min, point);
             max = glm::max(max, point);
@@ -75,20 +90,30 @@ struct Bouding_box {
         return *this;
     }
 
+    // Bounds of all eight transformed corners of the box, for affine transforms: the
+    // transformed center plus the half extent projected onto each axis through |transform|.
     Bouding_box operator*(const glm::mat4& transform) const {
-        auto min_ = glm::vec3(transform * glm::vec4(min, 1.0f));
-        auto max_ = glm::vec3(transform * glm::vec4(max, 1.0f));
-        return Bouding_box{min_, max_};
+        if (is_empty()) {
+            return *this;
+        }
+        auto center_ = glm::vec3(transform * glm::vec4(center(), 1.0f));
+        auto half_extent = extent() * 0.5f;
+        auto half_extent_ = 
+            glm::abs(glm::vec3(transform[0])) * half_extent.x +
+            glm::abs(glm::vec3(transform[1])) * half_extent.y +
+            glm::abs(glm::vec3(transform[2])) * half_extent.z;
+        return Bouding_box{center_ - half_extent_, center_ + half_extent_};
     }
 
     Bouding_box& operator*=(const glm::mat4& transform) {
-        auto min_ = glm::vec3(transform * glm::vec4(min, 1.0f));
-        auto max_ = glm::vec3(transform * glm::vec4(max, 1.0f));
-        min = min_;
-        max = max_;
+        *this = *this * transform;
         return *this;
     }
 
+    bool is_empty() const {
+        return min.x > max.x || min.y > max.y || min.z > max.z;
+    }
+
     bool overlap(const Bouding_box& other) const {
         return min.x <= other.max.x && max.x >= other.min.x &&
                min.y <= other.max.y && max.y >= other.min.y &&
@@ -148,5 +173,551 @@ struct Plane {
      
 };
 
+// Planes as vec4(normal, w) with normals pointing inwards, so dot(normal, p) + w >= 0
+// inside; the plane layout of simd::transform_planes and simd::cull_spheres.
+struct Frustum {
+    glm::vec4 planes[6]{};
+
+    Frustum() = default;
+
+    // from an OpenGL view projection matrix (clip z in [-w, w]), planes normalized:
+    // left, right, bottom, top, near, far
+    static Frustum from_matrix(const glm::mat4& view_projection) {
+        auto row = [&](int i) {
+            return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+        };
+        auto r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+        Frustum frustum{};
+        frustum.planes[0] = r3 + r0;
+        frustum.planes[1] = r3 - r0;
+        frustum.planes[2] = r3 + r1;
+        frustum.planes[3] = r3 - r1;
+        frustum.planes[4] = r3 + r2;
+        frustum.planes[5] = r3 - r2;
+        for (auto& plane : frustum.planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return frustum;
+    }
+
+    bool intersects(const Sphere& sphere) const {
+        for (const auto& plane : planes) {
+            if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // conservative: boxes near a frustum corner may pass although outside
+    bool intersects(const Bouding_box& box) const {
+        auto center = box.center();
+        auto half_extent = box.extent() * 0.5f;
+        for (const auto& plane : planes) {
+            auto normal = glm::vec3(plane);
+            if (glm::dot(normal, center) + plane.w < -glm::dot(glm::abs(normal), half_extent)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Batched math kernels over arrays of glm values, for transform and culling code
+// that processes thousands of objects at once. The AVX2 (with FMA) and SSE4.1
+// paths are selected at compile time from the target flags, every kernel has a
+// scalar glm fallback. Outputs may alias their inputs.
+namespace simd {
+
+inline const char* instruction_set() {
+#if defined(RTR_SIMD_AVX2)
+    return "AVX2";
+#elif defined(RTR_SIMD_SSE4)
+    return "SSE4.1";
+#else
+    return "scalar";
+#endif
+}
+
+// Same formula as the vector paths of compose_trs, so single and batched results match.
+inline glm::mat4 compose_trs(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+    float xx = rotation.x * rotation.x, yy = rotation.y * rotation.y, zz = rotation.z * rotation.z;
+    float xy = rotation.x * rotation.y, xz = rotation.x * rotation.z, yz = rotation.y * rotation.z;
+    float wx = rotation.w * rotation.x, wy = rotation.w * rotation.y, wz = rotation.w * rotation.z;
+
+    glm::mat4 result{};
+    result[0] = glm::vec4(scale.x * (1.0f - 2.0f * (yy + zz)), scale.y * (2.0f * (xy + wz)), scale.z * (2.0f * (xz - wy)), 0.0f);
+    result[1] = glm::vec4(scale.x * (2.0f * (xy - wz)), scale.y * (1.0f - 2.0f * (xx + zz)), scale.z * (2.0f * (yz + wx)), 0.0f);
+    result[2] = glm::vec4(scale.x * (2.0f * (xz + wy)), scale.y * (2.0f * (yz - wx)), scale.z * (1.0f - 2.0f * (xx + yy)), 0.0f);
+    result[3] = glm::vec4(position, 1.0f);
+    return result;
+}
+
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+
+namespace detail {
+
+inline __m128 madd(__m128 a, __m128 b, __m128 c) {
+#if defined(RTR_SIMD_AVX2)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+template<int lane>
+inline __m128 splat(__m128 v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(lane, lane, lane, lane));
+}
+
+inline void store_vec3(glm::vec3& out, __m128 v) {
+    _mm_storel_pi(reinterpret_cast<__m64*>(&out.x), v);
+    _mm_store_ss(&out.z, _mm_movehl_ps(v, v));
+}
+
+// column = c0 * v.x + c1 * v.y + c2 * v.z + c3 * v.w
+inline __m128 combine(__m128 c0, __m128 c1, __m128 c2, __m128 c3, __m128 v) {
+    auto result = _mm_mul_ps(c3, splat<3>(v));
+    result = madd(c2, splat<2>(v), result);
+    result = madd(c1, splat<1>(v), result);
+    return madd(c0, splat<0>(v), result);
+}
+
+// four quaternions as one register per component
+struct Quat4 {
+    __m128 x, y, z, w;
+
+    static Quat4 load(const glm::quat* q) {
+        return Quat4{
+            _mm_set_ps(q[3].x, q[2].x, q[1].x, q[0].x),
+            _mm_set_ps(q[3].y, q[2].y, q[1].y, q[0].y),
+            _mm_set_ps(q[3].z, q[2].z, q[1].z, q[0].z),
+            _mm_set_ps(q[3].w, q[2].w, q[1].w, q[0].w)
+        };
+    }
+};
+
+struct Vec3x4 {
+    __m128 x, y, z;
+
+    static Vec3x4 load(const glm::vec3* v) {
+        return Vec3x4{
+            _mm_set_ps(v[3].x, v[2].x, v[1].x, v[0].x),
+            _mm_set_ps(v[3].y, v[2].y, v[1].y, v[0].y),
+            _mm_set_ps(v[3].z, v[2].z, v[1].z, v[0].z)
+        };
+    }
+
+    void store(glm::vec3* out) const {
+        auto x_ = x, y_ = y, z_ = z, w_ = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(x_, y_, z_, w_);
+        store_vec3(out[0], x_);
+        store_vec3(out[1], y_);
+        store_vec3(out[2], z_);
+        store_vec3(out[3], w_);
+    }
+};
+
+}
+
+#endif
+
+// out[i] = lhs[i] * rhs[i]
+inline void multiply(const glm::mat4* lhs, const glm::mat4* rhs, glm::mat4* out, std::size_t count) {
+    std::size_t i = 0;
+#if defined(RTR_SIMD_AVX2)
+    for (; i < count; i++) {
+        auto a = glm::value_ptr(lhs[i]);
+        auto b = glm::value_ptr(rhs[i]);
+        auto a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 0));
+        auto a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+        auto a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+        auto a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+        // two result columns per register
+        auto b01 = _mm256_loadu_ps(b + 0);
+        auto b23 = _mm256_loadu_ps(b + 8);
+
+        auto r01 = _mm256_mul_ps(a0, _mm256_permute_ps(b01, 0x00));
+        r01 = _mm256_fmadd_ps(a1, _mm256_permute_ps(b01, 0x55), r01);
+        r01 = _mm256_fmadd_ps(a2, _mm256_permute_ps(b01, 0xAA), r01);
+        r01 = _mm256_fmadd_ps(a3, _mm256_permute_ps(b01, 0xFF), r01);
+
+        auto r23 = _mm256_mul_ps(a0, _mm256_permute_ps(b23, 0x00));
+        r23 = _mm256_fmadd_ps(a1, _mm256_permute_ps(b23, 0x55), r23);
+        r23 = _mm256_fmadd_ps(a2, _mm256_permute_ps(b23, 0xAA), r23);
+        r23 = _mm256_fmadd_ps(a3, _mm256_permute_ps(b23, 0xFF), r23);
+
+        auto o = glm::value_ptr(out[i]);
+        _mm256_storeu_ps(o + 0, r01);
+        _mm256_storeu_ps(o + 8, r23);
+    }
+#elif defined(RTR_SIMD_SSE4)
+    for (; i < count; i++) {
+        auto a = glm::value_ptr(lhs[i]);
+        auto b = glm::value_ptr(rhs[i]);
+        auto a0 = _mm_loadu_ps(a + 0), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+        auto b0 = _mm_loadu_ps(b + 0), b1 = _mm_loadu_ps(b + 4), b2 = _mm_loadu_ps(b + 8), b3 = _mm_loadu_ps(b + 12);
+
+        auto o = glm::value_ptr(out[i]);
+        _mm_storeu_ps(o + 0, detail::combine(a0, a1, a2, a3, b0));
+        _mm_storeu_ps(o + 4, detail::combine(a0, a1, a2, a3, b1));
+        _mm_storeu_ps(o + 8, detail::combine(a0, a1, a2, a3, b2));
+        _mm_storeu_ps(o + 12, detail::combine(a0, a1, a2, a3, b3));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = lhs[i] * rhs[i];
+    }
+}
+
+// out[i] = lhs * rhs[i], e.g. one parent matrix applied to all of its children
+inline void multiply(const glm::mat4& lhs, const glm::mat4* rhs, glm::mat4* out, std::size_t count) {
+    std::size_t i = 0;
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+    auto a = glm::value_ptr(lhs);
+    auto a0 = _mm_loadu_ps(a + 0), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+    for (; i < count; i++) {
+        auto b = glm::value_ptr(rhs[i]);
+        auto b0 = _mm_loadu_ps(b + 0), b1 = _mm_loadu_ps(b + 4), b2 = _mm_loadu_ps(b + 8), b3 = _mm_loadu_ps(b + 12);
+
+        auto o = glm::value_ptr(out[i]);
+        _mm_storeu_ps(o + 0, detail::combine(a0, a1, a2, a3, b0));
+        _mm_storeu_ps(o + 4, detail::combine(a0, a1, a2, a3, b1));
+        _mm_storeu_ps(o + 8, detail::combine(a0, a1, a2, a3, b2));
+        _mm_storeu_ps(o + 12, detail::combine(a0, a1, a2, a3, b3));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = lhs * rhs[i];
+    }
+}
+
+// out[i] = translate(positions[i]) * scale(scales[i]) * mat4_cast(rotations[i]), the Node order
+inline void compose_trs(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, glm::mat4* out, std::size_t count) {
+    std::size_t i = 0;
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+    const auto one = _mm_set1_ps(1.0f);
+    const auto two = _mm_set1_ps(2.0f);
+    for (; i + 4 <= count; i += 4) {
+        auto q = detail::Quat4::load(rotations + i);
+        auto p = detail::Vec3x4::load(positions + i);
+        auto s = detail::Vec3x4::load(scales + i);
+
+        auto xx = _mm_mul_ps(q.x, q.x), yy = _mm_mul_ps(q.y, q.y), zz = _mm_mul_ps(q.z, q.z);
+        auto xy = _mm_mul_ps(q.x, q.y), xz = _mm_mul_ps(q.x, q.z), yz = _mm_mul_ps(q.y, q.z);
+        auto wx = _mm_mul_ps(q.w, q.x), wy = _mm_mul_ps(q.w, q.y), wz = _mm_mul_ps(q.w, q.z);
+
+        // m<column><row>, rotation rows scaled by the matching scale component
+        auto m00 = _mm_mul_ps(s.x, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))));
+        auto m01 = _mm_mul_ps(s.y, _mm_mul_ps(two, _mm_add_ps(xy, wz)));
+        auto m02 = _mm_mul_ps(s.z, _mm_mul_ps(two, _mm_sub_ps(xz, wy)));
+        auto m10 = _mm_mul_ps(s.x, _mm_mul_ps(two, _mm_sub_ps(xy, wz)));
+        auto m11 = _mm_mul_ps(s.y, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))));
+        auto m12 = _mm_mul_ps(s.z, _mm_mul_ps(two, _mm_add_ps(yz, wx)));
+        auto m20 = _mm_mul_ps(s.x, _mm_mul_ps(two, _mm_add_ps(xz, wy)));
+        auto m21 = _mm_mul_ps(s.y, _mm_mul_ps(two, _mm_sub_ps(yz, wx)));
+        auto m22 = _mm_mul_ps(s.z, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))));
+        auto m03 = _mm_setzero_ps(), m13 = _mm_setzero_ps(), m23 = _mm_setzero_ps();
+        auto m30 = p.x, m31 = p.y, m32 = p.z, m33 = one;
+
+        _MM_TRANSPOSE4_PS(m00, m01, m02, m03);
+        _MM_TRANSPOSE4_PS(m10, m11, m12, m13);
+        _MM_TRANSPOSE4_PS(m20, m21, m22, m23);
+        _MM_TRANSPOSE4_PS(m30, m31, m32, m33);
+
+        const __m128 columns[4][4] = {
+            {m00, m10, m20, m30},
+            {m01, m11, m21, m31},
+            {m02, m12, m22, m32},
+            {m03, m13, m23, m33}
+        };
+        for (int lane = 0; lane < 4; lane++) {
+            auto o = glm::value_ptr(out[i + lane]);
+            for (int column = 0; column < 4; column++) {
+                _mm_storeu_ps(o + column * 4, columns[lane][column]);
+            }
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = compose_trs(positions[i], rotations[i], scales[i]);
+    }
+}
+
+// out[i] = normalize(rotations[i]), zero length quaternions become identity like glm::normalize
+inline void normalize(const glm::quat* rotations, glm::quat* out, std::size_t count) {
+    std::size_t i = 0;
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+    const auto zero = _mm_setzero_ps();
+    const auto one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4) {
+        auto q = detail::Quat4::load(rotations + i);
+        auto length2 = _mm_mul_ps(q.x, q.x);
+        length2 = detail::madd(q.y, q.y, length2);
+        length2 = detail::madd(q.z, q.z, length2);
+        length2 = detail::madd(q.w, q.w, length2);
+
+        auto is_valid = _mm_cmpgt_ps(length2, zero);
+        auto inverse_length = _mm_div_ps(one, _mm_sqrt_ps(length2));
+        auto x = _mm_and_ps(is_valid, _mm_mul_ps(q.x, inverse_length));
+        auto y = _mm_and_ps(is_valid, _mm_mul_ps(q.y, inverse_length));
+        auto z = _mm_and_ps(is_valid, _mm_mul_ps(q.z, inverse_length));
+        auto w = _mm_blendv_ps(one, _mm_mul_ps(q.w, inverse_length), is_valid);
+
+        alignas(16) float xs[4], ys[4], zs[4], ws[4];
+        _mm_store_ps(xs, x);
+        _mm_store_ps(ys, y);
+        _mm_store_ps(zs, z);
+        _mm_store_ps(ws, w);
+        for (int lane = 0; lane < 4; lane++) {
+            out[i + lane] = glm::quat(ws[lane], xs[lane], ys[lane], zs[lane]);
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = glm::normalize(rotations[i]);
+    }
+}
+
+// out[i] = rotations[i] * vectors[i]
+inline void rotate(const glm::quat* rotations, const glm::vec3* vectors, glm::vec3* out, std::size_t count) {
+    std::size_t i = 0;
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+    const auto two = _mm_set1_ps(2.0f);
+    for (; i + 4 <= count; i += 4) {
+        auto q = detail::Quat4::load(rotations + i);
+        auto v = detail::Vec3x4::load(vectors + i);
+
+        // v + w * t + cross(q.xyz, t) with t = 2 * cross(q.xyz, v)
+        auto tx = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(q.y, v.z), _mm_mul_ps(q.z, v.y)));
+        auto ty = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(q.z, v.x), _mm_mul_ps(q.x, v.z)));
+        auto tz = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(q.x, v.y), _mm_mul_ps(q.y, v.x)));
+
+        detail::Vec3x4 result{
+            _mm_add_ps(detail::madd(q.w, tx, v.x), _mm_sub_ps(_mm_mul_ps(q.y, tz), _mm_mul_ps(q.z, ty))),
+            _mm_add_ps(detail::madd(q.w, ty, v.y), _mm_sub_ps(_mm_mul_ps(q.z, tx), _mm_mul_ps(q.x, tz))),
+            _mm_add_ps(detail::madd(q.w, tz, v.z), _mm_sub_ps(_mm_mul_ps(q.x, ty), _mm_mul_ps(q.y, tx)))
+        };
+        result.store(out + i);
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = rotations[i] * vectors[i];
+    }
+}
+
+// out[i] = lhs[i] * rhs[i], out may alias either input
+inline void multiply(const glm::quat* lhs, const glm::quat* rhs, glm::quat* out, std::size_t count) {
+    std::size_t i = 0;
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+    for (; i + 4 <= count; i += 4) {
+        auto p = detail::Quat4::load(lhs + i);
+        auto q = detail::Quat4::load(rhs + i);
+
+        auto w = _mm_sub_ps(_mm_mul_ps(p.w, q.w), detail::madd(p.x, q.x, detail::madd(p.y, q.y, _mm_mul_ps(p.z, q.z))));
+        auto x = _mm_sub_ps(detail::madd(p.w, q.x, detail::madd(p.x, q.w, _mm_mul_ps(p.y, q.z))), _mm_mul_ps(p.z, q.y));
+        auto y = _mm_sub_ps(detail::madd(p.w, q.y, detail::madd(p.y, q.w, _mm_mul_ps(p.z, q.x))), _mm_mul_ps(p.x, q.z));
+        auto z = _mm_sub_ps(detail::madd(p.w, q.z, detail::madd(p.z, q.w, _mm_mul_ps(p.x, q.y))), _mm_mul_ps(p.y, q.x));
+
+        alignas(16) float xs[4], ys[4], zs[4], ws[4];
+        _mm_store_ps(xs, x);
+        _mm_store_ps(ys, y);
+        _mm_store_ps(zs, z);
+        _mm_store_ps(ws, w);
+        for (int lane = 0; lane < 4; lane++) {
+            out[i + lane] = glm::quat(ws[lane], xs[lane], ys[lane], zs[lane]);
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = lhs[i] * rhs[i];
+    }
+}
+
+// out[i] = (transform * vec4(points[i], 1)).xyz, for affine transforms
+inline void transform_points(const glm::mat4& transform, const glm::vec3* points, glm::vec3* out, std::size_t count) {
+    std::size_t i = 0;
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+    auto m = glm::value_ptr(transform);
+    auto c0 = _mm_loadu_ps(m + 0), c1 = _mm_loadu_ps(m + 4), c2 = _mm_loadu_ps(m + 8), c3 = _mm_loadu_ps(m + 12);
+    for (; i < count; i++) {
+        auto result = detail::madd(c2, _mm_set1_ps(points[i].z), c3);
+        result = detail::madd(c1, _mm_set1_ps(points[i].y), result);
+        result = detail::madd(c0, _mm_set1_ps(points[i].x), result);
+        detail::store_vec3(out[i], result);
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = glm::vec3(transform * glm::vec4(points[i], 1.0f));
+    }
+}
+
+// like transform_points followed by the perspective divide, e.g. NDC corners back to world space
+inline void project_points(const glm::mat4& transform, const glm::vec3* points, glm::vec3* out, std::size_t count) {
+    std::size_t i = 0;
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+    auto m = glm::value_ptr(transform);
+    auto c0 = _mm_loadu_ps(m + 0), c1 = _mm_loadu_ps(m + 4), c2 = _mm_loadu_ps(m + 8), c3 = _mm_loadu_ps(m + 12);
+    for (; i < count; i++) {
+        auto result = detail::madd(c2, _mm_set1_ps(points[i].z), c3);
+        result = detail::madd(c1, _mm_set1_ps(points[i].y), result);
+        result = detail::madd(c0, _mm_set1_ps(points[i].x), result);
+        detail::store_vec3(out[i], _mm_div_ps(result, detail::splat<3>(result)));
+    }
+#endif
+    for (; i < count; i++) {
+        auto result = transform * glm::vec4(points[i], 1.0f);
+        out[i] = glm::vec3(result) / result.w;
+    }
+}
+
+// out[i] = transform * vec4(points[i], 1) without the divide, e.g. positions to clip space
+inline void transform_points(const glm::mat4& transform, const glm::vec3* points, glm::vec4* out, std::size_t count) {
+    std::size_t i = 0;
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+    auto m = glm::value_ptr(transform);
+    auto c0 = _mm_loadu_ps(m + 0), c1 = _mm_loadu_ps(m + 4), c2 = _mm_loadu_ps(m + 8), c3 = _mm_loadu_ps(m + 12);
+    for (; i < count; i++) {
+        auto result = detail::madd(c2, _mm_set1_ps(points[i].z), c3);
+        result = detail::madd(c1, _mm_set1_ps(points[i].y), result);
+        result = detail::madd(c0, _mm_set1_ps(points[i].x), result);
+        _mm_storeu_ps(glm::value_ptr(out[i]), result);
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = transform * glm::vec4(points[i], 1.0f);
+    }
+}
+
+// Planes are vec4(normal, w) with dot(normal, p) + w = 0. To move them along with
+// points transformed by m, pass plane_transform(m).
+inline glm::mat4 plane_transform(const glm::mat4& point_transform) {
+    return glm::transpose(glm::inverse(point_transform));
+}
+
+// out[i] = transform * planes[i]
+inline void transform_planes(const glm::mat4& transform, const glm::vec4* planes, glm::vec4* out, std::size_t count) {
+    std::size_t i = 0;
+#if defined(RTR_SIMD_AVX2)
+    auto m = glm::value_ptr(transform);
+    auto c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 0));
+    auto c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 4));
+    auto c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 8));
+    auto c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 12));
+    // two planes per register
+    for (; i + 2 <= count; i += 2) {
+        auto p = _mm256_loadu_ps(glm::value_ptr(planes[i]));
+        auto result = _mm256_mul_ps(c0, _mm256_permute_ps(p, 0x00));
+        result = _mm256_fmadd_ps(c1, _mm256_permute_ps(p, 0x55), result);
+        result = _mm256_fmadd_ps(c2, _mm256_permute_ps(p, 0xAA), result);
+        result = _mm256_fmadd_ps(c3, _mm256_permute_ps(p, 0xFF), result);
+        _mm256_storeu_ps(glm::value_ptr(out[i]), result);
+    }
+#endif
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+    {
+        auto m = glm::value_ptr(transform);
+        auto c0 = _mm_loadu_ps(m + 0), c1 = _mm_loadu_ps(m + 4), c2 = _mm_loadu_ps(m + 8), c3 = _mm_loadu_ps(m + 12);
+        for (; i < count; i++) {
+            _mm_storeu_ps(glm::value_ptr(out[i]), detail::combine(c0, c1, c2, c3, _mm_loadu_ps(glm::value_ptr(planes[i]))));
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = transform * planes[i];
+    }
+}
+
+// is_visible[i] = whether the sphere vec4(center, radius) spheres[i] intersects the frustum
+inline void cull_spheres(const Frustum& frustum, const glm::vec4* spheres, uint8_t* is_visible, std::size_t count) {
+    std::size_t i = 0;
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+    __m128 nx[6], ny[6], nz[6], nw[6];
+    for (int p = 0; p < 6; p++) {
+        nx[p] = _mm_set1_ps(frustum.planes[p].x);
+        ny[p] = _mm_set1_ps(frustum.planes[p].y);
+        nz[p] = _mm_set1_ps(frustum.planes[p].z);
+        nw[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+    auto zero = _mm_setzero_ps();
+    // four spheres at a time, transposed to one register per component
+    for (; i + 4 <= count; i += 4) {
+        auto x = _mm_loadu_ps(glm::value_ptr(spheres[i + 0]));
+        auto y = _mm_loadu_ps(glm::value_ptr(spheres[i + 1]));
+        auto z = _mm_loadu_ps(glm::value_ptr(spheres[i + 2]));
+        auto r = _mm_loadu_ps(glm::value_ptr(spheres[i + 3]));
+        _MM_TRANSPOSE4_PS(x, y, z, r);
+
+        auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            auto distance = detail::madd(nx[p], x, detail::madd(ny[p], y, detail::madd(nz[p], z, nw[p])));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, r), zero));
+        }
+        auto mask = _mm_movemask_ps(inside);
+        is_visible[i + 0] = (mask >> 0) & 1;
+        is_visible[i + 1] = (mask >> 1) & 1;
+        is_visible[i + 2] = (mask >> 2) & 1;
+        is_visible[i + 3] = (mask >> 3) & 1;
+    }
+#endif
+    for (; i < count; i++) {
+        is_visible[i] = frustum.intersects(Sphere(glm::vec3(spheres[i]), spheres[i].w)) ? 1 : 0;
+    }
+}
+
+// is_visible[i] = whether boxes[i] intersects the frustum, conservative like Frustum::intersects
+inline void cull_boxes(const Frustum& frustum, const Bouding_box* boxes, uint8_t* is_visible, std::size_t count) {
+    std::size_t i = 0;
+#if defined(RTR_SIMD_AVX2) || defined(RTR_SIMD_SSE4)
+    __m128 nx[6], ny[6], nz[6], nw[6], ax[6], ay[6], az[6];
+    for (int p = 0; p < 6; p++) {
+        const auto& plane = frustum.planes[p];
+        nx[p] = _mm_set1_ps(plane.x);
+        ny[p] = _mm_set1_ps(plane.y);
+        nz[p] = _mm_set1_ps(plane.z);
+        nw[p] = _mm_set1_ps(plane.w);
+        ax[p] = _mm_set1_ps(std::fabs(plane.x));
+        ay[p] = _mm_set1_ps(std::fabs(plane.y));
+        az[p] = _mm_set1_ps(std::fabs(plane.z));
+    }
+    auto half = _mm_set1_ps(0.5f);
+    auto zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        const auto* b = boxes + i;
+        auto min_x = _mm_set_ps(b[3].min.x, b[2].min.x, b[1].min.x, b[0].min.x);
+        auto min_y = _mm_set_ps(b[3].min.y, b[2].min.y, b[1].min.y, b[0].min.y);
+        auto min_z = _mm_set_ps(b[3].min.z, b[2].min.z, b[1].min.z, b[0].min.z);
+        auto max_x = _mm_set_ps(b[3].max.x, b[2].max.x, b[1].max.x, b[0].max.x);
+        auto max_y = _mm_set_ps(b[3].max.y, b[2].max.y, b[1].max.y, b[0].max.y);
+        auto max_z = _mm_set_ps(b[3].max.z, b[2].max.z, b[1].max.z, b[0].max.z);
+
+        auto cx = _mm_mul_ps(_mm_add_ps(min_x, max_x), half);
+        auto cy = _mm_mul_ps(_mm_add_ps(min_y, max_y), half);
+        auto cz = _mm_mul_ps(_mm_add_ps(min_z, max_z), half);
+        auto ex = _mm_mul_ps(_mm_sub_ps(max_x, min_x), half);
+        auto ey = _mm_mul_ps(_mm_sub_ps(max_y, min_y), half);
+        auto ez = _mm_mul_ps(_mm_sub_ps(max_z, min_z), half);
+
+        auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            auto distance = detail::madd(nx[p], cx, detail::madd(ny[p], cy, detail::madd(nz[p], cz, nw[p])));
+            auto radius = detail::madd(ax[p], ex, detail::madd(ay[p], ey, _mm_mul_ps(az[p], ez)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+        }
+        auto mask = _mm_movemask_ps(inside);
+        is_visible[i + 0] = (mask >> 0) & 1;
+        is_visible[i + 1] = (mask >> 1) & 1;
+        is_visible[i + 2] = (mask >> 2) & 1;
+        is_visible[i + 3] = (mask >> 3) & 1;
+    }
+#endif
+    for (; i < count; i++) {
+        is_visible[i] = frustum.intersects(boxes[i]) ? 1 : 0;
+    }
+}
+
+}
+
 };
 
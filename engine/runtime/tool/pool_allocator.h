@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+namespace rtr {
+
+struct Pool_stats {
+    std::string name{};
+    std::size_t block_size{};
+    std::size_t used_blocks{};
+    std::size_t peak_used_blocks{};
+    std::size_t capacity_blocks{};
+    std::size_t slab_count{};
+    // allocations that were bigger than one block and went to the global heap
+    std::size_t fallback_allocations{};
+};
+
+// Fixed size blocks carved from slabs; freed blocks go on an intrusive free list and
+// are handed out again before a new slab is allocated. Slabs are only returned when
+// the pool is destroyed. Blocks allocated one after another are adjacent in memory.
+class Block_pool {
+private:
+    struct Free_block {
+        Free_block* next;
+    };
+
+    std::string m_name{};
+    std::size_t m_block_size{};
+    std::size_t m_block_alignment{};
+    std::size_t m_blocks_per_slab{};
+
+    std::vector<void*> m_slabs{};
+    Free_block* m_free_list{nullptr};
+    std::byte* m_slab_cursor{nullptr};
+    std::byte* m_slab_end{nullptr};
+
+    std::size_t m_used_blocks{0};
+    std::size_t m_peak_used_blocks{0};
+    std::size_t m_fallback_allocations{0};
+    mutable std::mutex m_mutex{};
+
+public:
+    Block_pool(std::string name, std::size_t block_size, std::size_t block_alignment, std::size_t slab_size = 64 * 1024) :
+        m_name(std::move(name)),
+        m_block_alignment(std::max(block_alignment, alignof(Free_block))) {
+        m_block_size = (std::max(block_size, sizeof(Free_block)) + m_block_alignment - 1) / m_block_alignment * m_block_alignment;
+        m_blocks_per_slab = std::max<std::size_t>(16, slab_size / m_block_size);
+    }
+
+    ~Block_pool() {
+        for (auto* slab : m_slabs) {
+            ::operator delete(slab, std::align_val_t{m_block_alignment});
+        }
+    }
+
+    Block_pool(const Block_pool&) = delete;
+    Block_pool& operator=(const Block_pool&) = delete;
+
+    std::size_t block_size() const { return m_block_size; }
+
+    void* allocate() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        void* block{};
+        if (m_free_list) {
+            block = m_free_list;
+            m_free_list = m_free_list->next;
+        } else {
+            if (m_slab_cursor == m_slab_end) {
+                add_slab();
+            }
+            block = m_slab_cursor;
+            m_slab_cursor += m_block_size;
+        }
+        m_used_blocks++;
+        m_peak_used_blocks = std::max(m_peak_used_blocks, m_used_blocks);
+        return block;
+    }
+
+    void deallocate(void* block) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto* free_block = static_cast<Free_block*>(block);
+        free_block->next = m_free_list;
+        m_free_list = free_block;
+        m_used_blocks--;
+    }
+
+    void count_fallback_allocation() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fallback_allocations++;
+    }
+
+    Pool_stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return Pool_stats{
+            m_name,
+            m_block_size,
+            m_used_blocks,
+            m_peak_used_blocks,
+            m_slabs.size() * m_blocks_per_slab,
+            m_slabs.size(),
+            m_fallback_allocations
+        };
+    }
+
+private:
+    void add_slab() {
+        auto* slab = ::operator new(m_block_size * m_blocks_per_slab, std::align_val_t{m_block_alignment});
+        m_slabs.push_back(slab);
+        m_slab_cursor = static_cast<std::byte*>(slab);
+        m_slab_end = m_slab_cursor + m_block_size * m_blocks_per_slab;
+    }
+};
+
+inline std::string readable_type_name(const std::type_info& type) {
+#if __has_include(<cxxabi.h>)
+    int status{};
+    if (auto* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status)) {
+        std::string result{demangled};
+        std::free(demangled);
+        return result;
+    }
+#endif
+    return type.name();
+}
+
+// Every Block_pool created through Pool_allocator, for occupancy reports.
+class Pool_registry {
+private:
+    std::vector<Block_pool*> m_pools{};
+    mutable std::mutex m_mutex{};
+
+public:
+    // pools are never destroyed: objects in static storage may release their blocks
+    // after every other static has gone away
+    static Pool_registry& instance() {
+        static auto* registry = new Pool_registry();
+        return *registry;
+    }
+
+    Block_pool* create_pool(std::string name, std::size_t block_size, std::size_t block_alignment) {
+        auto* pool = new Block_pool(std::move(name), block_size, block_alignment);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pools.push_back(pool);
+        return pool;
+    }
+
+    std::vector<Pool_stats> stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<Pool_stats> result{};
+        result.reserve(m_pools.size());
+        for (auto* pool : m_pools) {
+            result.push_back(pool->stats());
+        }
+        return result;
+    }
+};
+
+// Stateless allocator that gives every type it is rebound to its own Block_pool, so
+// std::allocate_shared<T>(Pool_allocator<T>{}) places each object together with its
+// control block in a pool shared by all objects of T. Array allocations go to the
+// global heap. Defining RTR_DISABLE_OBJECT_POOLS turns it into std::allocator.
+template<typename T, typename Tag = T>
+class Pool_allocator {
+public:
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = Pool_allocator<U, Tag>;
+    };
+
+    Pool_allocator() noexcept = default;
+
+    template<typename U>
+    Pool_allocator(const Pool_allocator<U, Tag>&) noexcept {}
+
+    T* allocate(std::size_t count) {
+#ifndef RTR_DISABLE_OBJECT_POOLS
+        if (count == 1) {
+            return static_cast<T*>(pool()->allocate());
+        }
+        pool()->count_fallback_allocation();
+#endif
+        return std::allocator<T>{}.allocate(count);
+    }
+
+    void deallocate(T* pointer, std::size_t count) noexcept {
+#ifndef RTR_DISABLE_OBJECT_POOLS
+        if (count == 1) {
+            pool()->deallocate(pointer);
+            return;
+        }
+#endif
+        std::allocator<T>{}.deallocate(pointer, count);
+    }
+
+    static Block_pool* pool() {
+        static auto* pool = Pool_registry::instance().create_pool(readable_type_name(typeid(Tag)), sizeof(T), alignof(T));
+        return pool;
+    }
+
+    template<typename U>
+    bool operator==(const Pool_allocator<U, Tag>&) const noexcept { return true; }
+};
+
+template<typename T, typename... Args>
+std::shared_ptr<T> make_pooled(Args&&... args) {
+    return std::allocate_shared<T>(Pool_allocator<T>{}, std::forward<Args>(args)...);
+}
+
+}
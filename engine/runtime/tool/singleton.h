@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 
 namespace rtr {
 
@@ -12,22 +13,26 @@ public:
     virtual ~Singleton();
 private:
     static std::shared_ptr<T> m_instance;
+    static std::once_flag m_instance_once;
 };
 
 template<typename T>
 std::shared_ptr<T> Singleton<T>::m_instance{};
 
+template<typename T>
+std::once_flag Singleton<T>::m_instance_once{};
+
 template<typename T>
 Singleton<T>::Singleton() = default;
 
 template<typename T>
 Singleton<T>::~Singleton() = default;
 
+// the first call may come from several job workers at once, e.g. the handle tables
+// reached from Mesh_renderer_component::tick during a parallel Scene::tick
 template<typename T>
 std::shared_ptr<T>& Singleton<T>::get_instance() {
-    if (!m_instance) {
-        m_instance = std::make_unique<T>();
-    }
+    std::call_once(m_instance_once, [] { m_instance = std::make_unique<T>(); });
     return m_instance;
 }
     
@@ -0,0 +1,339 @@
+#pragma once
+
+#include "engine/runtime/tool/job_system.h"
+#include "engine/runtime/tool/math.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace rtr {
+
+struct Triangle_hit {
+    // into the index list the hierarchy was built from, in triangles
+    uint32_t triangle_index{};
+    // in multiples of the ray direction
+    float distance{};
+    // barycentric coordinates of the hit: v0 * (1 - u - v) + v1 * u + v2 * v
+    float u{};
+    float v{};
+    Triangle triangle{};
+};
+
+// Static bounding volume hierarchy over the triangles of a mesh, for ray casts.
+// Built top down with binned SAH splits on all three axes; subtrees above
+// parallel_build_threshold triangles are built as jobs on the Job_system. The
+// triangles are copied in leaf order, so a leaf tests a contiguous run of them.
+class Triangle_bvh {
+public:
+    static constexpr uint32_t max_leaf_size = 4;
+    static constexpr uint32_t parallel_build_threshold = 8192;
+
+private:
+    // inner nodes: children at first and first + 1; leaves: count triangles from first
+    struct Node {
+        glm::vec3 min{};
+        uint32_t first{};
+        glm::vec3 max{};
+        uint32_t count{};
+    };
+
+    static constexpr int bin_count = 12;
+    // deeper than this splits fall back to the median, bounding the traversal stack
+    static constexpr int max_sah_depth = 32;
+    static constexpr int max_depth = 64;
+
+    std::vector<Node> m_nodes{};
+    std::vector<Triangle> m_triangles{};
+    std::vector<uint32_t> m_triangle_indices{};
+
+    // build scratch
+    std::vector<Bouding_box> m_triangle_boxes{};
+    std::vector<glm::vec3> m_centroids{};
+    std::atomic<uint32_t> m_node_count{0};
+
+public:
+    // positions as xyz floats, indices as triangle lists
+    Triangle_bvh(const std::vector<float>& positions, const std::vector<uint32_t>& indices) {
+        build(positions, indices);
+    }
+
+    static std::shared_ptr<Triangle_bvh> create(const std::vector<float>& positions, const std::vector<uint32_t>& indices) {
+        return std::make_shared<Triangle_bvh>(positions, indices);
+    }
+
+    std::size_t triangle_count() const { return m_triangles.size(); }
+    std::size_t node_count() const { return m_nodes.size(); }
+
+    Bouding_box bounds() const {
+        return m_nodes.empty() ? Bouding_box{} : Bouding_box{m_nodes[0].min, m_nodes[0].max};
+    }
+
+    // nearest hit closer than max_distance, both faces count
+    bool raycast(const Ray& ray, float max_distance, Triangle_hit& hit) const {
+        if (m_nodes.empty()) {
+            return false;
+        }
+
+        auto inverse_direction = glm::vec3(1.0f) / ray.direction;
+        float entry{};
+        if (!intersect(m_nodes[0], ray.origin, inverse_direction, max_distance, entry)) {
+            return false;
+        }
+
+        bool is_hit = false;
+        std::array<std::pair<uint32_t, float>, 2 * max_depth> stack{};
+        int stack_size = 0;
+        stack[stack_size++] = {0, entry};
+
+        while (stack_size > 0) {
+            auto [index, node_entry] = stack[--stack_size];
+            if (node_entry > max_distance) {
+                continue;
+            }
+            const auto& node = m_nodes[index];
+
+            if (node.count > 0) {
+                for (auto i = node.first; i < node.first + node.count; i++) {
+                    float distance{}, u{}, v{};
+                    if (intersect(m_triangles[i], ray, max_distance, distance, u, v)) {
+                        max_distance = distance;
+                        hit = Triangle_hit{m_triangle_indices[i], distance, u, v, m_triangles[i]};
+                        is_hit = true;
+                    }
+                }
+                continue;
+            }
+
+            float left_entry{}, right_entry{};
+            bool is_left_hit = intersect(m_nodes[node.first], ray.origin, inverse_direction, max_distance, left_entry);
+            bool is_right_hit = intersect(m_nodes[node.first + 1], ray.origin, inverse_direction, max_distance, right_entry);
+            if (is_left_hit && is_right_hit) {
+                // the nearer child is popped first
+                if (left_entry <= right_entry) {
+                    stack[stack_size++] = {node.first + 1, right_entry};
+                    stack[stack_size++] = {node.first, left_entry};
+                } else {
+                    stack[stack_size++] = {node.first, left_entry};
+                    stack[stack_size++] = {node.first + 1, right_entry};
+                }
+            } else if (is_left_hit) {
+                stack[stack_size++] = {node.first, left_entry};
+            } else if (is_right_hit) {
+                stack[stack_size++] = {node.first + 1, right_entry};
+            }
+        }
+        return is_hit;
+    }
+
+    // Moller-Trumbore
+    static bool intersect(const Triangle& triangle, const Ray& ray, float max_distance, float& distance, float& u, float& v) {
+        auto edge1 = triangle.v1 - triangle.v0;
+        auto edge2 = triangle.v2 - triangle.v0;
+        auto p = glm::cross(ray.direction, edge2);
+        auto determinant = glm::dot(edge1, p);
+        if (std::fabs(determinant) < std::numeric_limits<float>::min()) {
+            return false;
+        }
+        auto inverse_determinant = 1.0f / determinant;
+        auto s = ray.origin - triangle.v0;
+        u = glm::dot(s, p) * inverse_determinant;
+        if (u < 0.0f || u > 1.0f) {
+            return false;
+        }
+        auto q = glm::cross(s, edge1);
+        v = glm::dot(ray.direction, q) * inverse_determinant;
+        if (v < 0.0f || u + v > 1.0f) {
+            return false;
+        }
+        distance = glm::dot(edge2, q) * inverse_determinant;
+        return distance >= 0.0f && distance < max_distance;
+    }
+
+private:
+    static bool intersect(const Node& node, const glm::vec3& origin, const glm::vec3& inverse_direction, float max_distance, float& entry) {
+        auto t0 = (node.min - origin) * inverse_direction;
+        auto t1 = (node.max - origin) * inverse_direction;
+        auto near = glm::min(t0, t1);
+        auto far = glm::max(t0, t1);
+        auto t_near = std::fmax(std::fmax(std::fmax(near.x, near.y), near.z), 0.0f);
+        auto t_far = std::fmin(std::fmin(std::fmin(far.x, far.y), far.z), max_distance);
+        entry = t_near;
+        return t_near <= t_far;
+    }
+
+    static float surface_area(const Bouding_box& box) {
+        auto extent = box.extent();
+        return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+
+    void build(const std::vector<float>& positions, const std::vector<uint32_t>& indices) {
+        auto triangle_count = static_cast<uint32_t>(indices.size() / 3);
+        if (triangle_count == 0) {
+            return;
+        }
+
+        auto vertex = [&](uint32_t index) {
+            return glm::vec3(positions[index * 3 + 0], positions[index * 3 + 1], positions[index * 3 + 2]);
+        };
+
+        std::vector<Triangle> triangles(triangle_count);
+        m_triangle_boxes.resize(triangle_count);
+        m_centroids.resize(triangle_count);
+        m_triangle_indices.resize(triangle_count);
+        std::iota(m_triangle_indices.begin(), m_triangle_indices.end(), 0);
+
+        auto& job_system = *Job_sys::get_instance();
+        job_system.parallel_for(triangle_count, job_system.suggest_grain_size(triangle_count), [&](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; i++) {
+                Triangle triangle{vertex(indices[i * 3 + 0]), vertex(indices[i * 3 + 1]), vertex(indices[i * 3 + 2])};
+                Bouding_box box{};
+                box += triangle.v0;
+                box += triangle.v1;
+                box += triangle.v2;
+                triangles[i] = triangle;
+                m_triangle_boxes[i] = box;
+                m_centroids[i] = box.center();
+            }
+        });
+
+        m_nodes.resize(2 * triangle_count - 1);
+        m_node_count = 1;
+        build_node(0, 0, triangle_count, 0);
+        m_nodes.resize(m_node_count);
+
+        m_triangles.resize(triangle_count);
+        for (uint32_t i = 0; i < triangle_count; i++) {
+            m_triangles[i] = triangles[m_triangle_indices[i]];
+        }
+
+        m_triangle_boxes = {};
+        m_centroids = {};
+    }
+
+    // fills m_nodes[index] with the subtree over m_triangle_indices[begin, end)
+    void build_node(uint32_t index, uint32_t begin, uint32_t end, int depth) {
+        Bouding_box box{};
+        Bouding_box centroid_bounds{};
+        for (auto i = begin; i < end; i++) {
+            box += m_triangle_boxes[m_triangle_indices[i]];
+            centroid_bounds += m_centroids[m_triangle_indices[i]];
+        }
+
+        auto& node = m_nodes[index];
+        node.min = box.min;
+        node.max = box.max;
+
+        auto count = end - begin;
+        auto middle = count > max_leaf_size && depth < max_depth ? find_split(begin, end, centroid_bounds, depth) : begin;
+        if (middle == begin) {
+            node.first = begin;
+            node.count = count;
+            return;
+        }
+
+        auto children = m_node_count.fetch_add(2, std::memory_order_relaxed);
+        node.first = children;
+        node.count = 0;
+
+        if (count >= parallel_build_threshold) {
+            auto& job_system = *Job_sys::get_instance();
+            auto left = job_system.schedule([this, children, begin, middle, depth]() {
+                build_node(children, begin, middle, depth + 1);
+            });
+            build_node(children + 1, middle, end, depth + 1);
+            job_system.wait(left);
+        } else {
+            build_node(children, begin, middle, depth + 1);
+            build_node(children + 1, middle, end, depth + 1);
+        }
+    }
+
+    // Partitions [begin, end) at the binned split with the lowest SAH cost and returns
+    // the first index of the right side. Ranges whose centroids coincide on every axis,
+    // and ranges past max_sah_depth, are split at the median.
+    uint32_t find_split(uint32_t begin, uint32_t end, const Bouding_box& centroid_bounds, int depth) {
+        auto count = end - begin;
+        auto extent = centroid_bounds.extent();
+        int longest_axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+        if (extent[longest_axis] <= 0.0f || depth >= max_sah_depth) {
+            return median_split(begin, end, longest_axis);
+        }
+
+        float best_cost = std::numeric_limits<float>::max();
+        int best_axis = -1;
+        int best_bin = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            if (extent[axis] <= 0.0f) {
+                continue;
+            }
+            std::array<Bouding_box, bin_count> bin_boxes{};
+            std::array<uint32_t, bin_count> bin_counts{};
+            auto scale = bin_count / extent[axis];
+            for (auto i = begin; i < end; i++) {
+                auto triangle = m_triangle_indices[i];
+                auto bin = std::min(bin_count - 1, static_cast<int>((m_centroids[triangle][axis] - centroid_bounds.min[axis]) * scale));
+                bin_boxes[bin] += m_triangle_boxes[triangle];
+                bin_counts[bin]++;
+            }
+
+            std::array<float, bin_count - 1> left_costs{};
+            Bouding_box left_box{};
+            uint32_t left_count = 0;
+            for (int bin = 0; bin < bin_count - 1; bin++) {
+                left_box += bin_boxes[bin];
+                left_count += bin_counts[bin];
+                left_costs[bin] = left_count ? surface_area(left_box) * left_count : 0.0f;
+            }
+            Bouding_box right_box{};
+            uint32_t right_count = 0;
+            for (int bin = bin_count - 1; bin > 0; bin--) {
+                right_box += bin_boxes[bin];
+                right_count += bin_counts[bin];
+                if (right_count == 0 || right_count == count) {
+                    continue;
+                }
+                auto cost = left_costs[bin - 1] + surface_area(right_box) * right_count;
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_bin = bin;
+                }
+            }
+        }
+
+        if (best_axis < 0) {
+            return median_split(begin, end, longest_axis);
+        }
+
+        auto scale = bin_count / extent[best_axis];
+        auto split = std::partition(
+            m_triangle_indices.begin() + begin,
+            m_triangle_indices.begin() + end,
+            [&](uint32_t triangle) {
+                auto bin = std::min(bin_count - 1, static_cast<int>((m_centroids[triangle][best_axis] - centroid_bounds.min[best_axis]) * scale));
+                return bin < best_bin;
+            }
+        );
+        return static_cast<uint32_t>(split - m_triangle_indices.begin());
+    }
+
+    uint32_t median_split(uint32_t begin, uint32_t end, int axis) {
+        auto middle = begin + (end - begin) / 2;
+        std::nth_element(
+            m_triangle_indices.begin() + begin,
+            m_triangle_indices.begin() + middle,
+            m_triangle_indices.begin() + end,
+            [&](uint32_t lhs, uint32_t rhs) { return m_centroids[lhs][axis] < m_centroids[rhs][axis]; }
+        );
+        return middle;
+    }
+};
+
+}
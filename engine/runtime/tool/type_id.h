@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace rtr {
+
+// Compile time type ids: FNV-1a of the type's spelling as the compiler prints it in
+// the signature of type_name<T>(). Stable within one build, not across compilers.
+template<typename T>
+constexpr std::string_view type_name() {
+#if defined(__clang__) || defined(__GNUC__)
+    return __PRETTY_FUNCTION__;
+#elif defined(_MSC_VER)
+    return __FUNCSIG__;
+#endif
+}
+
+constexpr uint64_t fnv1a_64(std::string_view text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : text) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+template<typename T>
+constexpr uint64_t type_id() {
+    return fnv1a_64(type_name<T>());
+}
+
+}
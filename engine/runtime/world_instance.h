@@ -0,0 +1,109 @@
+#pragma once
+
+#include "engine/runtime/context/swap/swap_data.h"
+#include "engine/runtime/context/tick_context/logic_tick_context.h"
+#include "engine/runtime/context/tick_context/render_tick_context.h"
+#include "engine/runtime/framework/core/world.h"
+#include "engine/runtime/function/input/input_system.h"
+#include "engine/runtime/function/render/frontend/frame_buffer.h"
+#include "engine/runtime/function/render/frontend/texture.h"
+#include "engine/runtime/function/render/render_system.h"
+#include <memory>
+#include <utility>
+
+namespace rtr {
+
+// A World ticked by Engine_runtime next to its main world, concurrently with the
+// other instances, and rendered into an offscreen target of its own. The render
+// pipeline, and with it shaders and every GPU resource of shared geometry,
+// materials and textures, is shared with the runtime's render system.
+class World_instance {
+private:
+    std::shared_ptr<World> m_world{};
+    std::shared_ptr<Render_system> m_render_system{};
+
+    std::shared_ptr<Texture_2D> m_color_target{};
+    std::shared_ptr<Frame_buffer> m_frame_buffer{};
+
+    Swap_data m_swap_data[2];
+    int m_render_swap_data_index{0};
+    int m_logic_swap_data_index{1};
+    // an instance added between frames has nothing to render until its first logic tick
+    bool m_has_logic_frame{false};
+    bool m_has_render_frame{false};
+
+    // instances are not driven by the window's input
+    Input_state m_input_state{};
+
+public:
+    World_instance(
+        const std::shared_ptr<World>& world,
+        const std::shared_ptr<Render_system>& render_system,
+        int width,
+        int height,
+        bool is_incremental_render
+    ) : m_world(world),
+        m_render_system(render_system),
+        m_color_target(Texture_2D::create_color_attachemnt_rgba(width, height)) {
+
+        m_frame_buffer = Frame_buffer::create(
+            width, height,
+            std::vector<std::shared_ptr<Texture>>{m_color_target},
+            Texture_2D::create_depth_attachemnt(width, height)
+        );
+
+        for (auto& swap_data : m_swap_data) {
+            swap_data.is_incremental = is_incremental_render;
+        }
+    }
+
+    static std::shared_ptr<World_instance> create(
+        const std::shared_ptr<World>& world,
+        const std::shared_ptr<Render_system>& render_system,
+        int width,
+        int height,
+        bool is_incremental_render = false
+    ) {
+        return std::make_shared<World_instance>(world, render_system, width, height, is_incremental_render);
+    }
+
+    const std::shared_ptr<World>& world() const { return m_world; }
+    const std::shared_ptr<Render_system>& render_system() const { return m_render_system; }
+
+    // what the last rendered frame of the world looks like
+    const std::shared_ptr<Texture_2D>& color_target() const { return m_color_target; }
+    const std::shared_ptr<Frame_buffer>& frame_buffer() const { return m_frame_buffer; }
+
+    Swap_data& render_swap_data() { return m_swap_data[m_render_swap_data_index]; }
+    Swap_data& logic_swap_data() { return m_swap_data[m_logic_swap_data_index]; }
+
+    // may run on any thread, see World::create_isolated
+    void logic_tick(float delta_time) {
+        m_world->tick(Logic_tick_context{
+            m_input_state,
+            logic_swap_data(),
+            delta_time
+        });
+        m_has_logic_frame = true;
+    }
+
+    // on the thread owning the GL context
+    void render_tick(float delta_time) {
+        if (!m_has_render_frame) {
+            return;
+        }
+        m_render_system->tick(Render_tick_context{
+            render_swap_data(),
+            delta_time,
+            m_frame_buffer
+        });
+    }
+
+    void swap() {
+        std::swap(m_render_swap_data_index, m_logic_swap_data_index);
+        logic_swap_data().clear();
+        m_has_render_frame = std::exchange(m_has_logic_frame, false);
+    }
+};
+
+}
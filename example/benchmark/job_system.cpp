@@ -0,0 +1,106 @@
+#include "engine/runtime/tool/job_system.h"
+#include "engine/runtime/tool/timer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace rtr;
+
+namespace {
+
+constexpr std::size_t element_count = 1 << 22;
+constexpr int repeat_count = 8;
+
+float heavy_work(float x) {
+    float result = x;
+    for (int i = 0; i < 16; i++) {
+        result = std::sin(result) * std::cos(result) + std::sqrt(std::abs(result) + 1.0f);
+    }
+    return result;
+}
+
+double run_parallel_for(Job_system& job_system, std::vector<float>& data) {
+    Timer timer{};
+    timer.start();
+    for (int r = 0; r < repeat_count; r++) {
+        job_system.parallel_for(data.size(), job_system.suggest_grain_size(data.size()), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                data[i] = heavy_work(data[i]);
+            }
+        });
+    }
+    return timer.elapsed_ms<double>() / repeat_count;
+}
+
+// a diamond shaped graph per iteration: split -> 4 independent jobs -> reduce
+double run_job_graph(Job_system& job_system, std::vector<float>& data) {
+    Timer timer{};
+    timer.start();
+    for (int r = 0; r < repeat_count; r++) {
+        auto quarter = data.size() / 4;
+        auto split = job_system.schedule([]() {});
+
+        std::vector<Job_handle> stages{};
+        for (std::size_t q = 0; q < 4; q++) {
+            stages.push_back(job_system.schedule([&, q]() {
+                for (std::size_t i = q * quarter; i < (q + 1) * quarter; i++) {
+                    data[i] = heavy_work(data[i]);
+                }
+            }, {split}));
+        }
+
+        float sum = 0.0f;
+        auto reduce = job_system.schedule([&]() {
+            for (auto value : data) {
+                sum += value;
+            }
+        }, stages);
+        job_system.wait(reduce);
+    }
+    return timer.elapsed_ms<double>() / repeat_count;
+}
+
+}
+
+int main() {
+    auto max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<float> data(element_count, 0.5f);
+
+    std::printf("job_system benchmark, %zu elements, %d repeats\n", element_count, repeat_count);
+    std::printf("%8s %14s %10s %14s %16s\n", "threads", "parallel_for", "speedup", "job_graph", "avg utilization");
+
+    double baseline_ms = 0.0;
+    for (unsigned int threads = 1; threads <= max_threads; threads++) {
+        Job_system job_system(threads - 1);
+
+        run_parallel_for(job_system, data);
+        job_system.reset_stats();
+
+        auto parallel_for_ms = run_parallel_for(job_system, data);
+        auto stats = job_system.stats();
+        auto job_graph_ms = run_job_graph(job_system, data);
+
+        if (threads == 1) {
+            baseline_ms = parallel_for_ms;
+        }
+
+        float utilization = 0.0f;
+        for (const auto& worker : stats) {
+            utilization += worker.utilization();
+        }
+        utilization /= static_cast<float>(stats.size());
+
+        std::printf(
+            "%8u %11.3f ms %9.2fx %11.3f ms %15.1f%%\n",
+            threads,
+            parallel_for_ms,
+            baseline_ms / parallel_for_ms,
+            job_graph_ms,
+            utilization * 100.0f
+        );
+    }
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "engine/runtime/function/render/material/shading/phong_material.h"
+#include "engine/runtime/function/render/frontend/texture.h"
+#include "engine/runtime/function/render/frontend/geometry.h"
+
+#include "engine/runtime/framework/component/camera/camera_component.h"
+#include "engine/runtime/framework/component/custom/rotate_component.h"
+#include "engine/runtime/framework/component/light/light_component.h"
+#include "engine/runtime/framework/component/mesh_renderer/mesh_renderer_component.h"
+#include "engine/runtime/framework/component/node/node_component.h"
+#include "engine/runtime/framework/component/shadow_caster/shadow_caster_component.h"
+#include "engine/runtime/framework/core/game_object.h"
+#include "engine/runtime/framework/core/scene.h"
+#include "engine/runtime/framework/core/world.h"
+
+#include "engine/runtime/resource/file_service.h"
+#include "engine/runtime/resource/loader/image.h"
+#include "engine/runtime/runtime.h"
+
+#include "engine/runtime/function/render/pipeline/forward_pipeline.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+using namespace rtr;
+
+// Runs several independent copies of the cubes scene in one headless runtime: every
+// world ticks on the job system at the same time as the others and renders into its
+// own offscreen target, while geometry, material, textures and shaders are shared.
+// usage: benchmark_multi_world [worlds] [frames] [cubes_per_side]
+int main(int argc, char** argv) {
+    int world_count = argc > 1 ? std::atoi(argv[1]) : 8;
+    int frame_count = argc > 2 ? std::atoi(argv[2]) : 300;
+    int cubes_per_side = argc > 3 ? std::atoi(argv[3]) : 20;
+    constexpr int target_width = 320;
+    constexpr int target_height = 180;
+
+    Engine_runtime_descriptor engine_runtime_descriptor{};
+    engine_runtime_descriptor.width = target_width;
+    engine_runtime_descriptor.height = target_height;
+    engine_runtime_descriptor.is_headless = true;
+    auto runtime = Engine_runtime::create(engine_runtime_descriptor);
+
+    auto forward_pipeline = Forward_pipeline::create(runtime->rhi_global_resource());
+    runtime->render_system()->set_render_pipeline(forward_pipeline);
+
+    auto main_tex = Image::create(
+        Image_format::RGB_ALPHA,
+        File_ser::get_instance()->get_absolute_path("assets/image/bricks/bricks.jpg")
+    );
+
+    auto texture_settings = Phong_texture_setting::create();
+    texture_settings->albedo_map = Texture_2D::create_image(main_tex);
+
+    auto phong_shader = Phong_material::phong_shader();
+    phong_shader->generate_all_shader_variants();
+    phong_shader->link_all_shader_variants(runtime->rhi_global_resource().device);
+
+    auto material = Phong_material::create();
+    material->phong_material_settings = Phong_material_setting::create();
+    material->phong_texture_settings = texture_settings;
+    material->parallax_settings = forward_pipeline->parallax_setting();
+    material->shadow_settings = forward_pipeline->shadow_setting();
+
+    auto box_geometry = Geometry::create_box();
+
+    for (int w = 0; w < world_count; w++) {
+        auto world = World::create_isolated("world_" + std::to_string(w));
+        Transform_storage::Scope scope{world->transform_storage()};
+
+        auto scene = world->add_scene("scene");
+        world->set_current_scene(scene);
+
+        auto camera_game_object = scene->add_game_object(Game_object::create("camera"));
+        auto camera_node = camera_game_object->add_component<Node_component>()->node();
+        camera_node->set_position(glm::vec3(0, 20 + w, 60));
+        camera_node->look_at_point(glm::vec3(0, 0, 0));
+        camera_game_object->add_component<Perspective_camera_component>();
+
+        auto dl_game_object = scene->add_game_object(Game_object::create("dl"));
+        auto dl_node = dl_game_object->add_component<Node_component>()->node();
+        dl_node->look_at_direction(glm::vec3(0, -1, 0));
+        dl_node->set_position(glm::vec3(0, 3, 0));
+        dl_game_object->add_component<Directional_light_component>();
+        auto dl_shadow_caster = dl_game_object->add_component<Directional_light_shadow_caster_component>();
+        dl_shadow_caster->shadow_caster()->shadow_map() = Texture_2D::create_color_attachemnt_rg(1024, 1024);
+
+        float spacing = 2.0f;
+        float offset = (cubes_per_side - 1) * spacing / 2.0f;
+        scene->reserve(cubes_per_side * cubes_per_side + 2);
+        for (int i = 0; i < cubes_per_side; ++i) {
+            for (int j = 0; j < cubes_per_side; ++j) {
+                auto cube = scene->add_game_object(Game_object::create("cube"));
+                auto cube_node = cube->add_component<Node_component>()->node();
+                cube_node->set_position(glm::vec3(i * spacing - offset, 0, j * spacing - offset));
+
+                auto mesh_renderer = cube->add_component<Mesh_renderer_component>()->mesh_renderer();
+                mesh_renderer->geometry() = box_geometry;
+                mesh_renderer->material() = material;
+
+                cube->add_component<Rotate_component>()->speed() = 0.1f * (w + 1);
+            }
+        }
+
+        runtime->add_world_instance(world, target_width, target_height);
+    }
+
+    // warm up shader variants and resource uploads before measuring
+    for (int i = 0; i < 10; i++) {
+        runtime->tick(runtime->get_delta_time());
+    }
+
+    auto& frame_pacer = runtime->frame_pacer();
+    frame_pacer.end_frame();
+    frame_pacer.reset_stats();
+    for (int i = 0; i < frame_count; i++) {
+        runtime->tick(runtime->get_delta_time());
+        frame_pacer.end_frame();
+    }
+
+    auto stats = frame_pacer.stats();
+    std::printf("multi world: %d worlds x %d objects, %d frames, %zu job workers\n",
+        world_count, cubes_per_side * cubes_per_side, frame_count, Job_sys::get_instance()->worker_count());
+    std::printf("mean %.3f ms  min %.3f ms  max %.3f ms  (%.1f world frames per second)\n",
+        stats.mean_frame_ms, stats.min_frame_ms, stats.max_frame_ms,
+        stats.mean_frame_ms > 0.0 ? 1000.0 * world_count / stats.mean_frame_ms : 0.0);
+
+    return 0;
+}
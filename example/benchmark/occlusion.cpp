@@ -0,0 +1,123 @@
+#include "engine/runtime/context/swap/renderable_object.h"
+#include "engine/runtime/function/render/frontend/geometry.h"
+#include "engine/runtime/function/render/utils/frustum_culler.h"
+#include "engine/runtime/function/render/utils/occlusion_culler.h"
+#include "engine/runtime/tool/job_system.h"
+#include "engine/runtime/tool/math.h"
+#include "engine/runtime/tool/timer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace rtr;
+
+// A city of box buildings with small props on the streets between them, seen
+// from street level by a camera walking down the main street. Every frame is
+// frustum culled, then occlusion culled by the CPU depth rasterizer, without a
+// window or GPU; prints the time of each stage and how much was occluded.
+// usage: benchmark_occlusion [frames] [blocks_per_side] [props_per_block]
+int main(int argc, char** argv) {
+    int frame_count = argc > 1 ? std::atoi(argv[1]) : 300;
+    int blocks_per_side = argc > 2 ? std::atoi(argv[2]) : 20;
+    int props_per_block = argc > 3 ? std::atoi(argv[3]) : 40;
+    constexpr float block_size = 20.0f;
+    constexpr float street_width = 8.0f;
+    constexpr float pitch = block_size + street_width;
+    float offset = (blocks_per_side - 1) * pitch / 2.0f;
+
+    auto box_geometry = Geometry::create_box();
+    auto box_handle = Geometry_table::get_instance()->acquire(box_geometry);
+
+    auto model_matrix = [](const glm::vec3& position, const glm::vec3& scale) {
+        return glm::scale(glm::translate(glm::mat4(1.0f), position), scale);
+    };
+
+    std::mt19937 random{7};
+    std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+    std::vector<Swap_renderable_object> buildings{};
+    std::vector<Swap_renderable_object> props{};
+    for (int i = 0; i < blocks_per_side; i++) {
+        for (int j = 0; j < blocks_per_side; j++) {
+            auto center = glm::vec3(i * pitch - offset, 0.0f, j * pitch - offset);
+            auto height = 10.0f + unit(random) * 40.0f;
+
+            Swap_renderable_object building{};
+            building.object_id = static_cast<uint32_t>(buildings.size());
+            building.geometry = box_handle;
+            building.model_matrix = model_matrix(center + glm::vec3(0.0f, height / 2.0f, 0.0f), glm::vec3(block_size, height, block_size));
+            buildings.push_back(building);
+
+            // along the streets on two sides of the block
+            for (int k = 0; k < props_per_block; k++) {
+                auto along = (unit(random) - 0.5f) * block_size;
+                auto across = block_size / 2.0f + 1.0f + unit(random) * (street_width - 2.0f);
+                auto position = k % 2 == 0 ? glm::vec3(along, 0.5f, across) : glm::vec3(across, 0.5f, along);
+
+                Swap_renderable_object prop{};
+                prop.object_id = static_cast<uint32_t>(props.size());
+                prop.geometry = box_handle;
+                prop.model_matrix = model_matrix(center + position, glm::vec3(1.0f));
+                props.push_back(prop);
+            }
+        }
+    }
+
+    auto projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+    Frustum_culler frustum_culler{};
+    Occlusion_culler occlusion_culler{};
+    std::vector<uint32_t> visible_buildings{};
+    std::vector<uint32_t> visible_props{};
+
+    double frustum_ms = 0.0, rasterize_ms = 0.0, test_ms = 0.0;
+    std::size_t frustum_visible = 0, occluded = 0, occluder_triangles = 0, max_occluded = 0;
+    std::size_t min_occluded = static_cast<std::size_t>(-1);
+    Timer timer{};
+
+    for (int frame = 0; frame < frame_count; frame++) {
+        // down the street between the first two rows of blocks, looking along it
+        auto t = static_cast<float>(frame) / std::max(frame_count - 1, 1);
+        auto eye = glm::vec3(-offset + pitch / 2.0f, 1.7f, -offset + t * 2.0f * offset);
+        auto view = glm::lookAt(eye, eye + glm::vec3(std::sin(t * 2.0f * PI) * 0.5f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        auto view_projection = projection * view;
+        auto frustum = Frustum::from_matrix(view_projection);
+
+        timer.start();
+        frustum_culler.reset_stats();
+        frustum_culler.cull(frustum, buildings, visible_buildings);
+        frustum_culler.cull(frustum, props, visible_props);
+        frustum_ms += timer.elapsed_ms<double>();
+
+        timer.start();
+        occlusion_culler.begin(view_projection);
+        occlusion_culler.add_candidates(buildings, visible_buildings);
+        occlusion_culler.add_candidates(props, visible_props);
+        occlusion_culler.rasterize_occluders();
+        rasterize_ms += timer.elapsed_ms<double>();
+
+        timer.start();
+        occlusion_culler.cull(buildings, visible_buildings);
+        occlusion_culler.cull(props, visible_props);
+        test_ms += timer.elapsed_ms<double>();
+
+        const auto& stats = occlusion_culler.stats();
+        frustum_visible += frustum_culler.stats().visible;
+        occluded += stats.occluded;
+        occluder_triangles += stats.occluder_triangles;
+        min_occluded = std::min(min_occluded, stats.occluded);
+        max_occluded = std::max(max_occluded, stats.occluded);
+    }
+
+    auto frames = static_cast<double>(std::max(frame_count, 1));
+    std::printf("%zu objects, %d frames, %dx%d depth buffer, %zu job workers\n",
+        buildings.size() + props.size(), frame_count,
+        occlusion_culler.rasterizer().width(), occlusion_culler.rasterizer().height(),
+        Job_sys::get_instance()->worker_count());
+    std::printf("per frame: frustum %.3f ms  occluders %.3f ms  occludees %.3f ms\n",
+        frustum_ms / frames, rasterize_ms / frames, test_ms / frames);
+    std::printf("per frame: %.1f in frustum  %.1f occluded (min %zu max %zu)  %.1f occluder triangles\n",
+        frustum_visible / frames, occluded / frames, min_occluded, max_occluded, occluder_triangles / frames);
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "engine/runtime/framework/component/mesh_renderer/mesh_renderer_component.h"
+#include "engine/runtime/framework/component/node/node_component.h"
+#include "engine/runtime/framework/core/prefab.h"
+#include "engine/runtime/framework/core/scene.h"
+#include "engine/runtime/framework/plugin/model_loader.h"
+#include "engine/runtime/resource/file_service.h"
+#include "engine/runtime/resource/loader/model.h"
+#include "engine/runtime/tool/timer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_set>
+
+using namespace rtr;
+
+static std::size_t distinct_geometry_count(const Scene& scene) {
+    std::unordered_set<const Geometry*> geometries{};
+    for (const auto& game_object : scene.game_objects()) {
+        if (auto mesh_renderer_component = game_object->get_component<Mesh_renderer_component>()) {
+            geometries.insert(mesh_renderer_component->mesh_renderer()->geometry().get());
+        }
+    }
+    return geometries.size();
+}
+
+// Places a model many times, once with Scene::add_model per copy and once by
+// instantiating a Prefab of it, and compares the time and the geometries created.
+// usage: benchmark_prefab [copies] [model path]
+int main(int argc, char** argv) {
+    int copy_count = argc > 1 ? std::atoi(argv[1]) : 1000;
+    std::string model_path = argc > 2 ? argv[2] : "assets/model/backpack/backpack.obj";
+
+    auto model = Model_assimp::create(File_ser::get_instance()->get_absolute_path(model_path));
+    auto model_loader = Model_loader<Phong_material>::create(Shadow_setting::create(), Parallax_setting::create());
+    constexpr float spacing = 4.0f;
+
+    Timer timer{};
+    {
+        auto scene = Scene::create("add_model");
+        timer.start();
+        for (int i = 0; i < copy_count; i++) {
+            auto root = scene->add_model("model", model, model_loader);
+            root->get_component<Node_component>()->node()->set_position(glm::vec3(i * spacing, 0.0f, 0.0f));
+        }
+        auto add_model_ms = timer.elapsed_ms<double>();
+        std::printf("add_model    %d copies  %8.3f ms  %zu game objects  %zu geometries\n",
+            copy_count, add_model_ms, scene->game_objects().size(), distinct_geometry_count(*scene));
+    }
+
+    {
+        auto scene = Scene::create("prefab");
+        timer.start();
+        auto prefab = Prefab::create("model", model, model_loader);
+        auto create_ms = timer.elapsed_ms<double>();
+
+        timer.start();
+        scene->reserve(copy_count * prefab->size());
+        for (int i = 0; i < copy_count; i++) {
+            auto root = scene->instantiate(*prefab);
+            root->get_component<Node_component>()->node()->set_position(glm::vec3(i * spacing, 0.0f, 0.0f));
+        }
+        auto instantiate_ms = timer.elapsed_ms<double>();
+        std::printf("prefab       %d copies  %8.3f ms  %zu game objects  %zu geometries  (capture %.3f ms)\n",
+            copy_count, instantiate_ms, scene->game_objects().size(), distinct_geometry_count(*scene), create_ms);
+    }
+
+    return 0;
+}
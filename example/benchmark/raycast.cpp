@@ -0,0 +1,73 @@
+#include "engine/runtime/framework/component/mesh_renderer/mesh_renderer_component.h"
+#include "engine/runtime/framework/component/node/node_component.h"
+#include "engine/runtime/framework/core/scene.h"
+#include "engine/runtime/framework/plugin/model_loader.h"
+#include "engine/runtime/resource/file_service.h"
+#include "engine/runtime/resource/loader/model.h"
+#include "engine/runtime/tool/job_system.h"
+#include "engine/runtime/tool/math.h"
+#include "engine/runtime/tool/timer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_set>
+
+using namespace rtr;
+
+// Loads a model, builds the triangle BVHs of its meshes and casts rays from the
+// middle of its bounds in random directions, the way picking and line of sight
+// checks would.
+// usage: benchmark_raycast [rays] [model path]
+int main(int argc, char** argv) {
+    int ray_count = argc > 1 ? std::atoi(argv[1]) : 10000;
+    std::string model_path = argc > 2 ? argv[2] : "assets/model/sponza/sponza.obj";
+
+    auto model = Model_assimp::create(File_ser::get_instance()->get_absolute_path(model_path));
+    auto model_loader = Model_loader<Phong_material>::create(Shadow_setting::create(), Parallax_setting::create());
+    auto scene = Scene::create("scene");
+    scene->add_model("model", model, model_loader);
+
+    Swap_data swap_data{};
+    scene->tick(Logic_tick_context{Input_state{}, swap_data, 16.0f});
+
+    Timer timer{};
+    timer.start();
+    scene->build_triangle_bvhs();
+    auto build_ms = timer.elapsed_ms<double>();
+
+    std::unordered_set<const Geometry*> geometries{};
+    std::size_t triangle_count = 0;
+    for (const auto& game_object : scene->game_objects()) {
+        auto renderer = game_object->get_component<Mesh_renderer_component>();
+        if (renderer && renderer->mesh_renderer()->geometry() && geometries.insert(renderer->mesh_renderer()->geometry().get()).second) {
+            triangle_count += renderer->mesh_renderer()->geometry()->triangle_bvh()->triangle_count();
+        }
+    }
+
+    auto bounds = scene->spatial_index().bounds();
+    auto origin = bounds.center();
+    std::mt19937 random{42};
+    std::normal_distribution<float> normal{};
+
+    int hit_count = 0;
+    double max_ms = 0.0;
+    Timer total_timer{};
+    total_timer.start();
+    for (int i = 0; i < ray_count; i++) {
+        auto direction = glm::normalize(glm::vec3(normal(random), normal(random), normal(random)));
+        timer.start();
+        auto hit = scene->raycast(Ray(origin, direction));
+        max_ms = std::max(max_ms, timer.elapsed_ms<double>());
+        hit_count += hit.is_hit() ? 1 : 0;
+    }
+    auto mean_ms = total_timer.elapsed_ms<double>() / std::max(1, ray_count);
+
+    std::printf("%zu geometries, %zu triangles, %zu objects, %zu job workers\n",
+        geometries.size(), triangle_count, scene->spatial_index().size(), Job_sys::get_instance()->worker_count());
+    std::printf("triangle bvh build %.3f ms\n", build_ms);
+    std::printf("%d rays, %d hits: mean %.4f ms  max %.4f ms\n", ray_count, hit_count, mean_ms, max_ms);
+    return 0;
+}
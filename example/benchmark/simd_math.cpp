@@ -0,0 +1,146 @@
+#include "engine/runtime/tool/math.h"
+#include "engine/runtime/tool/timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace rtr;
+
+namespace {
+
+constexpr std::size_t element_count = 1 << 16;
+constexpr int repeat_count = 64;
+
+template<typename Func>
+double measure_ms(Func&& func) {
+    func();
+    Timer timer{};
+    timer.start();
+    for (int r = 0; r < repeat_count; r++) {
+        func();
+    }
+    return timer.elapsed_ms<double>() / repeat_count;
+}
+
+float max_difference(const glm::mat4& a, const glm::mat4& b) {
+    float result = 0.0f;
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            result = std::max(result, std::abs(a[column][row] - b[column][row]));
+        }
+    }
+    return result;
+}
+
+float max_difference(const glm::vec3& a, const glm::vec3& b) {
+    return std::max({std::abs(a.x - b.x), std::abs(a.y - b.y), std::abs(a.z - b.z)});
+}
+
+float max_difference(const glm::vec4& a, const glm::vec4& b) {
+    return std::max(max_difference(glm::vec3(a), glm::vec3(b)), std::abs(a.w - b.w));
+}
+
+float max_difference(const glm::quat& a, const glm::quat& b) {
+    return std::max({std::abs(a.x - b.x), std::abs(a.y - b.y), std::abs(a.z - b.z), std::abs(a.w - b.w)});
+}
+
+template<typename T>
+float max_difference(const std::vector<T>& a, const std::vector<T>& b) {
+    float result = 0.0f;
+    for (std::size_t i = 0; i < a.size(); i++) {
+        result = std::max(result, max_difference(a[i], b[i]));
+    }
+    return result;
+}
+
+void report(const char* name, double glm_ms, double simd_ms, float error) {
+    std::printf("%-18s glm %8.3f ms  simd %8.3f ms  speedup %5.2fx  max error %.2e\n",
+        name, glm_ms, simd_ms, glm_ms / simd_ms, error);
+}
+
+}
+
+int main() {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+
+    std::vector<glm::vec3> positions(element_count), scales(element_count), points(element_count);
+    std::vector<glm::quat> rotations(element_count);
+    std::vector<glm::mat4> parents(element_count), locals(element_count);
+    std::vector<glm::vec4> planes(element_count);
+    for (std::size_t i = 0; i < element_count; i++) {
+        positions[i] = glm::vec3(dist(rng), dist(rng), dist(rng));
+        scales[i] = glm::vec3(1.0f) + glm::abs(glm::vec3(dist(rng), dist(rng), dist(rng))) * 0.1f;
+        points[i] = glm::vec3(dist(rng), dist(rng), dist(rng));
+        rotations[i] = glm::quat(dist(rng), dist(rng), dist(rng), dist(rng));
+        planes[i] = glm::vec4(glm::normalize(glm::vec3(dist(rng), dist(rng), dist(rng))), dist(rng));
+    }
+
+    std::vector<glm::quat> glm_rotations(element_count), simd_rotations(element_count);
+    auto glm_ms = measure_ms([&] {
+        for (std::size_t i = 0; i < element_count; i++) {
+            glm_rotations[i] = glm::normalize(rotations[i]);
+        }
+    });
+    auto simd_ms = measure_ms([&] { simd::normalize(rotations.data(), simd_rotations.data(), element_count); });
+    report("quat normalize", glm_ms, simd_ms, max_difference(glm_rotations, simd_rotations));
+    rotations = glm_rotations;
+
+    std::vector<glm::vec3> glm_points(element_count), simd_points(element_count);
+    glm_ms = measure_ms([&] {
+        for (std::size_t i = 0; i < element_count; i++) {
+            glm_points[i] = rotations[i] * points[i];
+        }
+    });
+    simd_ms = measure_ms([&] { simd::rotate(rotations.data(), points.data(), simd_points.data(), element_count); });
+    report("quat rotate", glm_ms, simd_ms, max_difference(glm_points, simd_points));
+
+    std::vector<glm::mat4> glm_matrices(element_count), simd_matrices(element_count);
+    glm_ms = measure_ms([&] {
+        for (std::size_t i = 0; i < element_count; i++) {
+            glm_matrices[i] = glm::translate(glm::identity<glm::mat4>(), positions[i]) *
+                glm::scale(glm::identity<glm::mat4>(), scales[i]) *
+                glm::mat4_cast(rotations[i]);
+        }
+    });
+    simd_ms = measure_ms([&] {
+        simd::compose_trs(positions.data(), rotations.data(), scales.data(), simd_matrices.data(), element_count);
+    });
+    report("trs compose", glm_ms, simd_ms, max_difference(glm_matrices, simd_matrices));
+
+    parents = glm_matrices;
+    std::shuffle(glm_matrices.begin(), glm_matrices.end(), rng);
+    locals = glm_matrices;
+    glm_ms = measure_ms([&] {
+        for (std::size_t i = 0; i < element_count; i++) {
+            glm_matrices[i] = parents[i] * locals[i];
+        }
+    });
+    simd_ms = measure_ms([&] { simd::multiply(parents.data(), locals.data(), simd_matrices.data(), element_count); });
+    report("mat4 multiply", glm_ms, simd_ms, max_difference(glm_matrices, simd_matrices));
+
+    const auto& transform = parents[0];
+    glm_ms = measure_ms([&] {
+        for (std::size_t i = 0; i < element_count; i++) {
+            glm_points[i] = glm::vec3(transform * glm::vec4(points[i], 1.0f));
+        }
+    });
+    simd_ms = measure_ms([&] { simd::transform_points(transform, points.data(), simd_points.data(), element_count); });
+    report("point transform", glm_ms, simd_ms, max_difference(glm_points, simd_points));
+
+    auto plane_transform = simd::plane_transform(transform);
+    std::vector<glm::vec4> glm_planes(element_count), simd_planes(element_count);
+    glm_ms = measure_ms([&] {
+        for (std::size_t i = 0; i < element_count; i++) {
+            glm_planes[i] = plane_transform * planes[i];
+        }
+    });
+    simd_ms = measure_ms([&] { simd::transform_planes(plane_transform, planes.data(), simd_planes.data(), element_count); });
+    report("plane transform", glm_ms, simd_ms, max_difference(glm_planes, simd_planes));
+
+    std::printf("%zu elements, %d repeats, instruction set: %s\n", element_count, repeat_count, simd::instruction_set());
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "engine/runtime/framework/component/custom/ping_pong_component.h"
+#include "engine/runtime/framework/component/mesh_renderer/mesh_renderer_component.h"
+#include "engine/runtime/framework/component/node/node_component.h"
+#include "engine/runtime/framework/core/game_object.h"
+#include "engine/runtime/framework/core/scene.h"
+#include "engine/runtime/function/render/frontend/geometry.h"
+#include "engine/runtime/tool/math.h"
+#include "engine/runtime/tool/timer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace rtr;
+
+// Frustum, sphere and ray queries over a grid of cubes, answered by the scene's
+// spatial index and by testing the world bounds of every object in turn. Every
+// moving_every-th cube moves up and down, the others are static.
+// usage: benchmark_spatial_query [cubes_per_side] [layers] [ticks] [moving_every]
+int main(int argc, char** argv) {
+    int cubes_per_side = argc > 1 ? std::atoi(argv[1]) : 60;
+    int layers = argc > 2 ? std::atoi(argv[2]) : 10;
+    int tick_count = argc > 3 ? std::atoi(argv[3]) : 100;
+    int moving_every = argc > 4 ? std::max(1, std::atoi(argv[4])) : 10;
+    constexpr float spacing = 2.0f;
+    float offset = (cubes_per_side - 1) * spacing / 2.0f;
+
+    auto scene = Scene::create("scene");
+    scene->set_name_index_enabled(false);
+    auto box_geometry = Geometry::create_box();
+
+    int cube_count = 0;
+    scene->reserve(cubes_per_side * cubes_per_side * layers);
+    for (int y = 0; y < layers; y++) {
+        for (int i = 0; i < cubes_per_side; i++) {
+            for (int j = 0; j < cubes_per_side; j++) {
+                auto cube = scene->add_game_object(Game_object::create("cube"));
+                auto cube_node = cube->add_component<Node_component>()->node();
+                auto position = glm::vec3(i * spacing - offset, y * spacing, j * spacing - offset);
+                cube_node->set_position(position);
+                cube->add_component<Mesh_renderer_component>()->mesh_renderer()->geometry() = box_geometry;
+                if (cube_count++ % moving_every == 0) {
+                    auto ping_pong = cube->add_component<Ping_pong_component>();
+                    ping_pong->position() = position;
+                    ping_pong->speed() = 0.002f;
+                } else {
+                    cube->set_static(true);
+                }
+            }
+        }
+    }
+
+    Swap_data swap_data{};
+    Timer timer{};
+    auto tick = [&]() {
+        swap_data.clear();
+        scene->tick(Logic_tick_context{Input_state{}, swap_data, 16.0f});
+    };
+
+    timer.start();
+    tick();
+    auto first_tick_ms = timer.elapsed_ms<double>();
+
+    timer.start();
+    for (int i = 0; i < tick_count; i++) {
+        tick();
+    }
+    auto tick_ms = timer.elapsed_ms<double>() / tick_count;
+
+    // what every query would do without the index
+    auto flat_query = [&](auto&& test) {
+        std::size_t count = 0;
+        for (const auto& game_object : scene->game_objects()) {
+            auto mesh_renderer = game_object->get_component<Mesh_renderer_component>()->mesh_renderer();
+            auto box = mesh_renderer->geometry()->bounding_box() * mesh_renderer->node()->model_matrix();
+            count += test(box) ? 1 : 0;
+        }
+        return count;
+    };
+
+    auto view = glm::lookAt(glm::vec3(0.0f, layers * spacing, offset + 10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    auto projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, offset);
+    auto frustum = Frustum::from_matrix(projection * view);
+    auto sphere = Sphere(glm::vec3(0.0f), spacing * 5.0f);
+    auto ray = Ray(glm::vec3(-offset - 10.0f, 1.0f, 0.5f), glm::vec3(1.0f, 0.0f, 0.0f));
+
+    std::vector<std::shared_ptr<Game_object>> found{};
+    std::vector<Scene_ray_hit> hits{};
+    constexpr int query_count = 100;
+
+    auto measure = [&](const char* name, auto&& indexed, auto&& flat) {
+        std::size_t indexed_count = 0;
+        timer.start();
+        for (int i = 0; i < query_count; i++) {
+            indexed_count = indexed();
+        }
+        auto indexed_ms = timer.elapsed_ms<double>() / query_count;
+
+        std::size_t flat_count = 0;
+        timer.start();
+        for (int i = 0; i < query_count; i++) {
+            flat_count = flat();
+        }
+        auto flat_ms = timer.elapsed_ms<double>() / query_count;
+
+        std::printf("%-8s %6zu found  index %8.4f ms  flat %8.4f ms (%zu found)\n",
+            name, indexed_count, indexed_ms, flat_ms, flat_count);
+    };
+
+    measure("frustum",
+        [&]() { found.clear(); scene->query(frustum, found); return found.size(); },
+        [&]() { return flat_query([&](const Bouding_box& box) { return frustum.intersects(box); }); }
+    );
+    measure("sphere",
+        [&]() { found.clear(); scene->query(sphere, found); return found.size(); },
+        [&]() {
+            return flat_query([&](const Bouding_box& box) {
+                auto to_center = sphere.center - glm::clamp(sphere.center, box.min, box.max);
+                return glm::dot(to_center, to_center) <= sphere.radius * sphere.radius;
+            });
+        }
+    );
+    measure("ray",
+        [&]() { hits.clear(); scene->query(ray, std::numeric_limits<float>::max(), hits); return hits.size(); },
+        [&]() {
+            auto inverse_direction = glm::vec3(1.0f) / ray.direction;
+            return flat_query([&](const Bouding_box& box) {
+                float distance{};
+                return Dynamic_bvh<Scene_spatial_object>::intersect(box, ray.origin, inverse_direction, std::numeric_limits<float>::max(), distance);
+            });
+        }
+    );
+
+    std::printf("%d cubes, 1 in %d moving: first tick %.3f ms (index build)  tick %.3f ms  tree cost %.1f\n",
+        cube_count, moving_every, first_tick_ms, tick_ms, scene->spatial_index().cost());
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "engine/runtime/framework/component/custom/rotate_component.h"
+#include "engine/runtime/framework/component/mesh_renderer/mesh_renderer_component.h"
+#include "engine/runtime/framework/component/node/node_component.h"
+#include "engine/runtime/framework/core/game_object.h"
+#include "engine/runtime/framework/core/scene.h"
+#include "engine/runtime/framework/system/rotate_system.h"
+#include "engine/runtime/tool/pool_allocator.h"
+#include "engine/runtime/tool/timer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace rtr;
+
+// Spawns, ticks and destroys the cube grid of example/engine/cubes.cpp without any
+// rendering. Built twice: benchmark_spawn with the object pools and
+// benchmark_spawn_no_pools with RTR_DISABLE_OBJECT_POOLS, to compare the two.
+// Passing "batched" rotates the cubes with Rotate_system instead of per component ticks.
+// usage: benchmark_spawn [layers] [ticks] [batched]
+int main(int argc, char** argv) {
+    int layers_y = argc > 1 ? std::atoi(argv[1]) : 7;
+    int tick_count = argc > 2 ? std::atoi(argv[2]) : 200;
+    bool is_batched = argc > 3 && std::string(argv[3]) == "batched";
+    constexpr int cubes_per_side = 30;
+    constexpr float spacing = 2.0f;
+    constexpr float offset = (cubes_per_side - 1) * spacing / 2.0f;
+
+    auto scene = Scene::create("scene");
+    if (is_batched) {
+        scene->add_system(Rotate_system::create());
+    }
+
+    Timer timer{};
+    timer.start();
+    int cube_count = 0;
+    for (int y_layer = 0; y_layer < layers_y; ++y_layer) {
+        for (int i = 0; i < cubes_per_side; ++i) {
+            for (int j = 0; j < cubes_per_side; ++j) {
+                auto cube = scene->add_game_object(Game_object::create("auto_cube_" + std::to_string(cube_count++)));
+                auto cube_node = cube->add_component<Node_component>()->node();
+                cube_node->set_position(glm::vec3(i * spacing - offset, y_layer * spacing, j * spacing - offset));
+                cube->add_component<Mesh_renderer_component>();
+                cube->add_component<Rotate_component>()->speed() = 0.1f;
+            }
+        }
+    }
+    auto spawn_ms = timer.elapsed_ms<double>();
+
+    Swap_data swap_data{};
+    timer.start();
+    for (int i = 0; i < tick_count; i++) {
+        swap_data.clear();
+        Logic_tick_context tick_context{Input_state{}, swap_data, 16.0f};
+        scene->tick(tick_context);
+    }
+    auto tick_ms = timer.elapsed_ms<double>() / tick_count;
+
+    std::printf("%d cubes, object pools %s\n", cube_count,
+#ifdef RTR_DISABLE_OBJECT_POOLS
+        "disabled"
+#else
+        "enabled"
+#endif
+    );
+    std::printf("spawn %.3f ms  tick %.3f ms (%s rotation)\n", spawn_ms, tick_ms, is_batched ? "batched" : "per component");
+
+    for (const auto& stats : Pool_registry::instance().stats()) {
+        std::printf("  %-40s block %4zu B  used %6zu  peak %6zu  capacity %6zu  slabs %4zu\n",
+            stats.name.c_str(), stats.block_size, stats.used_blocks, stats.peak_used_blocks,
+            stats.capacity_blocks, stats.slab_count);
+    }
+
+    timer.start();
+    scene->clear();
+    std::printf("destroy %.3f ms\n", timer.elapsed_ms<double>());
+    return 0;
+}
@@ -21,6 +21,8 @@
 #include "engine/runtime/framework/core/game_object.h"
 #include "engine/runtime/framework/core/scene.h"
 #include "engine/runtime/framework/core/world.h"
+#include "engine/runtime/framework/system/ping_pong_system.h"
+#include "engine/runtime/framework/system/rotate_system.h"
 
 #include "engine/runtime/resource/file_service.h"
 #include "engine/runtime/resource/loader/image.h"
@@ -37,6 +39,8 @@ using namespace rtr;
 int main() {
 
     Engine_runtime_descriptor engine_runtime_descriptor{};
+    engine_runtime_descriptor.runtime_mode = Runtime_mode::THREADED;
+    engine_runtime_descriptor.fixed_logic_hz = 30.0f;
     auto runtime = Engine_runtime::create(engine_runtime_descriptor);
     auto forward_pipeline = Forward_pipeline::create(
         runtime->rhi_global_resource()
@@ -113,6 +117,7 @@ int main() {
 
     auto scene = world->add_scene(Scene::create("scene1"));
     world->set_current_scene(scene);
+    scene->set_tick_mode(Scene_tick_mode::PARALLEL);
 
     // auto spherical = Skybox::create(Texture_image::create(bk_image));
     // scene->set_skybox(spherical);
@@ -127,6 +132,10 @@ int main() {
     }));
     scene->set_skybox(cubemap);
 
+    // the rotate and ping pong components below are ticked in batches by these systems
+    scene->add_system(Rotate_system::create());
+    scene->add_system(Ping_pong_system::create());
+
     auto camera_game_object = scene->add_game_object(Game_object::create("camera"));
     auto camera_node = camera_game_object->add_component<Node_component>()->node();
     camera_node->set_position(glm::vec3(0, 0, 60));
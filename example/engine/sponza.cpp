@@ -39,6 +39,7 @@ using namespace rtr;
 int main() {
 
     Engine_runtime_descriptor engine_runtime_descriptor{};
+    engine_runtime_descriptor.runtime_mode = Runtime_mode::THREADED;
     auto runtime = Engine_runtime::create(engine_runtime_descriptor);
     auto forward_pipeline = Forward_pipeline::create(
         runtime->rhi_global_resource()
@@ -75,6 +76,10 @@ int main() {
     );
     
     sponza_root_go->get_component<Node_component>()->node()->set_scale(glm::vec3(0.0005f));
+    // the architecture never moves: draw it from the scene's static render list
+    for (auto& go : scene->game_objects()) {
+        go->set_static(true);
+    }
     // auto sponza_rot = sponza_root_go->add_component<Rotate_component>();
     // sponza_rot->speed() = 0.01f;
 